@@ -0,0 +1,49 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Global operator new/delete replacement counting heap use of a benchmark process
+
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> allocationCount{0};
+std::atomic<size_t> live{0};
+std::atomic<size_t> peak{0};
+
+void* countedAlloc(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    ++allocationCount;
+    size_t now = live += malloc_usable_size(p);
+    size_t highest = peak.load();
+    while (now > highest && !peak.compare_exchange_weak(highest, now)) {}
+    return p;
+}
+
+void countedFree(void* p) {
+    if (!p) return;
+    live -= malloc_usable_size(p);
+    std::free(p);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+
+namespace alloc_counter {
+
+size_t allocations() { return allocationCount.load(); }
+size_t liveBytes() { return live.load(); }
+size_t peakBytes() { return peak.load(); }
+void resetPeak() { peak = live.load(); }
+
+} // namespace alloc_counter
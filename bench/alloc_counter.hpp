@@ -0,0 +1,26 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Global operator new/delete replacement counting heap use of a benchmark process
+
+#ifndef USGSM2M_ALLOC_COUNTER_HPP
+#define USGSM2M_ALLOC_COUNTER_HPP
+
+#include <cstddef>
+
+namespace alloc_counter {
+
+/// @brief Number of operator new calls so far, including those made inside the library
+size_t allocations();
+
+/// @brief Bytes currently allocated through operator new
+size_t liveBytes();
+
+/// @brief Highest liveBytes since the last resetPeak
+size_t peakBytes();
+
+/// @brief Restart peak tracking from the current liveBytes
+void resetPeak();
+
+} // namespace alloc_counter
+
+#endif //USGSM2M_ALLOC_COUNTER_HPP
@@ -0,0 +1,100 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Benchmark of response parsing on a large synthetic sceneSearch page.
+/// Compares parseJsonResponse, which moves the data subtree out of the parsed document,
+/// with the previous pipeline that deep-copied it, reporting time and peak heap.
+///
+/// Usage: usgsm2m_parse_bench [scenes=2000] [iterations=10]
+
+#include "usgsm2m.hpp"
+#include "alloc_counter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+/// @brief A sceneSearch response with the given number of scenes in full metadata form
+std::string makeScenePage(int scenes) {
+    nlohmann::json results = nlohmann::json::array();
+    for (int i = 0; i < scenes; ++i) {
+        nlohmann::json metadata = nlohmann::json::array();
+        for (int f = 0; f < 12; ++f) {
+            metadata.push_back({{"id", "5e83d0b8" + std::to_string(f)}, {"fieldName", "Field " + std::to_string(f)},
+                {"dictionaryLink", "https://www.usgs.gov/centers/eros/science/landsat-data-dictionary"},
+                {"value", "LC08_L1TP_" + std::to_string(100000 + i) + "_20200101"}});
+        }
+        results.push_back({
+            {"entityId", "LC8" + std::to_string(1000000 + i)},
+            {"displayId", "LC08_L1TP_" + std::to_string(i) + "_20200101_20200113_01_T1"},
+            {"cloudCover", std::to_string(i % 100)},
+            {"publishDate", "2020-01-13 00:00:00"},
+            {"temporalCoverage", {{"startDate", "2020-01-01 00:00:00"}, {"endDate", "2020-01-01 00:00:00"}}},
+            {"spatialBounds", {{"type", "Polygon"}, {"coordinates",
+                {{{-105.1, 39.7}, {-103.4, 39.7}, {-103.4, 41.5}, {-105.1, 41.5}, {-105.1, 39.7}}}}}},
+            {"metadata", metadata},
+        });
+    }
+    nlohmann::json page = {
+        {"requestId", 1}, {"version", "stable"}, {"sessionId", 1}, {"errorCode", nullptr}, {"errorMessage", nullptr},
+        {"data", {{"totalHits", scenes}, {"recordsReturned", scenes}, {"nextRecord", scenes + 1}, {"results", results}}},
+    };
+    return page.dump();
+}
+
+/// @brief The pipeline before the data subtree was moved out
+DefaultResponse parseWithCopy(const std::string& body) {
+    DefaultResponse result;
+    nlohmann::json jsonResponse = nlohmann::json::parse(body);
+    result.success = true;
+    if (jsonResponse.contains("data") && !jsonResponse["data"].is_null()) {
+        result.data = jsonResponse["data"];
+    }
+    return result;
+}
+
+struct Sample {
+    double millis;
+    size_t peak;
+};
+
+template <typename Parse>
+std::vector<Sample> run(int iterations, Parse parse) {
+    std::vector<Sample> samples;
+    for (int i = 0; i < iterations; ++i) {
+        size_t base = alloc_counter::liveBytes();
+        alloc_counter::resetPeak();
+        auto start = std::chrono::steady_clock::now();
+        DefaultResponse response = parse();
+        auto stop = std::chrono::steady_clock::now();
+        if (!response.success) {
+            std::cerr << "parse failed: " << response.errorData.errorMessage << "\n";
+            std::exit(1);
+        }
+        samples.push_back({std::chrono::duration<double, std::milli>(stop - start).count(), alloc_counter::peakBytes() - base});
+    }
+    std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.millis < b.millis; });
+    return samples;
+}
+
+void report(const char* name, const std::vector<Sample>& samples) {
+    std::cout << name << ": min " << samples.front().millis << " ms, median "
+              << samples[samples.size() / 2].millis << " ms, peak heap "
+              << samples.front().peak / (1024.0 * 1024.0) << " MiB\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int scenes = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    std::string body = makeScenePage(scenes);
+    std::cout << "scene page: " << scenes << " scenes, " << body.size() / (1024.0 * 1024.0) << " MiB\n";
+
+    USGS_M2M_API api;
+    report("copy data (previous)", run(iterations, [&] { return parseWithCopy(body); }));
+    report("move data (parseJsonResponse)", run(iterations, [&] { return api.parseJsonResponse(body, 200, true); }));
+    return 0;
+}
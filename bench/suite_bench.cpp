@@ -0,0 +1,214 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Benchmark suite covering request building, response parsing and round trips
+/// for one representative call of each endpoint family (dataset, scene, download, tram, misc).
+///
+/// build   Endpoint method up to the dumped payload, via prepareRequest, nothing is sent
+/// parse   parseJsonResponse on a representative response body of the family
+/// e2e     Blocking round trip against a local stand-in (tools/m2m_standin), only with --url
+///
+/// Usage: usgsm2m_bench [--url http://127.0.0.1:8080/api/] [--iterations N] [--e2e-iterations N] [--family NAME]
+
+#include "usgsm2m.hpp"
+#include "alloc_counter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+struct Stats {
+    double opsPerSecond = 0;
+    double p50Micros = 0;
+    double p99Micros = 0;
+    double allocationsPerOp = 0;
+    size_t failures = 0;
+};
+
+/// @brief Time op iterations times, op returns false on failure
+template <typename Op>
+Stats measure(int iterations, Op op) {
+    // Warm up the handle pool, connections and lazily built statics
+    for (int i = 0; i < std::min(iterations, 10); ++i) op();
+
+    Stats stats;
+    std::vector<double> micros;
+    micros.reserve(static_cast<size_t>(iterations));
+
+    size_t allocationsBefore = alloc_counter::allocations();
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (!op()) ++stats.failures;
+        auto stop = std::chrono::steady_clock::now();
+        micros.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    size_t allocations = alloc_counter::allocations() - allocationsBefore;
+
+    std::sort(micros.begin(), micros.end());
+    stats.opsPerSecond = iterations / seconds;
+    stats.p50Micros = micros[micros.size() / 2];
+    stats.p99Micros = micros[std::min(micros.size() - 1, micros.size() * 99 / 100)];
+    stats.allocationsPerOp = static_cast<double>(allocations) / iterations;
+    return stats;
+}
+
+void report(const std::string& family, const char* stage, const Stats& stats) {
+    std::printf("%-10s %-6s %12.0f %10.1f %10.1f %10.1f", family.c_str(), stage,
+        stats.opsPerSecond, stats.p50Micros, stats.p99Micros, stats.allocationsPerOp);
+    if (stats.failures) std::printf("   (%zu failed)", stats.failures);
+    std::printf("\n");
+}
+
+std::string envelope(nlohmann::json data) {
+    return nlohmann::json{{"requestId", 1}, {"version", "stable"}, {"sessionId", 1}, {"data", std::move(data)},
+        {"errorCode", nullptr}, {"errorMessage", nullptr}}.dump();
+}
+
+nlohmann::json polygon() {
+    return {{"type", "Polygon"}, {"coordinates",
+        {{{-105.1, 39.7}, {-103.4, 39.7}, {-103.4, 41.5}, {-105.1, 41.5}, {-105.1, 39.7}}}}};
+}
+
+std::string datasetSearchResponse() {
+    nlohmann::json datasets = nlohmann::json::array();
+    for (int i = 0; i < 50; ++i) {
+        datasets.push_back({{"abstractText", std::string(400, 'a')}, {"acquisitionStart", "2013-03-18 00:00:00"},
+            {"acquisitionEnd", nullptr}, {"catalogs", {"EE", "GV"}}, {"collectionName", "Landsat 8-9 OLI/TIRS C2 L2"},
+            {"datasetAlias", "landsat_ot_c2_l2_" + std::to_string(i)}, {"datasetId", "5e83d14f" + std::to_string(i)},
+            {"datasetCategoryId", "17"}, {"doiNumber", nullptr}, {"ingestFrequency", "P1D"},
+            {"keywords", "Landsat,OLI,TIRS"}, {"sceneCount", 1500000 + i}, {"spatialBounds", polygon()},
+            {"supportCloudCover", true}, {"supportDeletionSearch", false}});
+    }
+    return envelope(std::move(datasets));
+}
+
+std::string sceneSearchResponse() {
+    nlohmann::json results = nlohmann::json::array();
+    for (int i = 1; i <= 100; ++i) {
+        results.push_back({{"entityId", "LC8" + std::to_string(1000000 + i)},
+            {"displayId", "LC08_L2SP_" + std::to_string(i) + "_20200101_20200113_02_T1"},
+            {"cloudCover", std::to_string(i % 100)}, {"publishDate", "2020-01-13 00:00:00"},
+            {"temporalCoverage", {{"startDate", "2020-01-01 00:00:00"}, {"endDate", "2020-01-01 00:00:00"}}},
+            {"spatialBounds", polygon()}, {"spatialCoverage", polygon()},
+            {"browse", {{{"browsePath", "https://ims.cr.usgs.gov/browse/" + std::to_string(i) + ".jpg"},
+                {"thumbnailPath", "https://ims.cr.usgs.gov/thumbnail/" + std::to_string(i) + ".jpg"}}}},
+            {"options", {{"bulk", true}, {"download", true}, {"order", true}, {"secondary", false}}}});
+    }
+    return envelope({{"results", std::move(results)}, {"recordsReturned", 100}, {"totalHits", 10000},
+        {"startingNumber", 1}, {"nextRecord", 101}});
+}
+
+std::string downloadRequestResponse() {
+    nlohmann::json available = nlohmann::json::array();
+    for (int i = 0; i < 50; ++i) {
+        available.push_back({{"downloadId", 500000 + i}, {"eulaCode", nullptr},
+            {"url", "https://dds.cr.usgs.gov/download/eyJpZCI6" + std::string(200, 'x') + std::to_string(i)}});
+    }
+    return envelope({{"availableDownloads", std::move(available)}, {"duplicateProducts", nlohmann::json::array()},
+        {"preparingDownloads", nlohmann::json::array()}, {"failed", nlohmann::json::array()},
+        {"newRecords", nlohmann::json::object()}, {"numInvalidScenes", 0}});
+}
+
+std::string tramOrderStatusResponse() {
+    nlohmann::json units = nlohmann::json::array();
+    for (int i = 0; i < 20; ++i) {
+        units.push_back({{"unitNumber", i + 1}, {"productCode", "L2SP"}, {"statusCode", "C"},
+            {"statusText", "Complete"}, {"entityId", "LC8" + std::to_string(1000000 + i)}});
+    }
+    return envelope({{"orderNumber", "0101910105551"}, {"statusCode", "C"}, {"statusText", "Complete"},
+        {"units", std::move(units)}});
+}
+
+std::string placenameResponse() {
+    nlohmann::json places = nlohmann::json::array();
+    for (int i = 0; i < 20; ++i) {
+        places.push_back({{"id", 1000 + i}, {"feature_id", 2000 + i}, {"placename", "Sioux Falls " + std::to_string(i)},
+            {"feature_code", "PPL"}, {"country_code", "US"}, {"latitude", 43.5}, {"longitude", -96.7}});
+    }
+    return envelope(std::move(places));
+}
+
+struct Family {
+    std::string name;
+    USGS_M2M_API::ApiCall call;
+    std::string response;
+};
+
+std::vector<Family> families() {
+    nlohmann::json temporalFilter = {{"start", "2020-01-01"}, {"end", "2020-12-31"}};
+    nlohmann::json spatialFilter = {{"filterType", "mbr"},
+        {"lowerLeft", {{"latitude", 39.7}, {"longitude", -105.1}}},
+        {"upperRight", {{"latitude", 41.5}, {"longitude", -103.4}}}};
+    nlohmann::json sceneFilter = {{"spatialFilter", spatialFilter},
+        {"acquisitionFilter", temporalFilter}, {"cloudCoverFilter", {{"min", 0}, {"max", 30}}}};
+
+    std::vector<Download> downloads;
+    for (int i = 0; i < 50; ++i) {
+        downloads.push_back({"LC8" + std::to_string(1000000 + i), "5e83d14fb9436d88", std::nullopt, std::nullopt});
+    }
+
+    return {
+        {"dataset", [=](USGS_M2M_API& c) {
+            return c.datasetSearch(std::nullopt, std::nullopt, std::string("landsat_ot_c2_l2"), true, std::nullopt,
+                std::nullopt, temporalFilter, spatialFilter);
+        }, datasetSearchResponse()},
+        {"scene", [=](USGS_M2M_API& c) {
+            return c.sceneSearch("landsat_ot_c2_l2", 100, 1, std::string("summary"), std::nullopt, std::nullopt,
+                std::nullopt, std::nullopt, sceneFilter);
+        }, sceneSearchResponse()},
+        {"download", [=](USGS_M2M_API& c) {
+            return c.downloadRequest(std::nullopt, std::nullopt, downloads, std::nullopt, std::string("bench"));
+        }, downloadRequestResponse()},
+        {"tram", [](USGS_M2M_API& c) {
+            return c.tramOrderStatus("0101910105551");
+        }, tramOrderStatusResponse()},
+        {"misc", [](USGS_M2M_API& c) {
+            return c.placename(std::string("US"), std::string("Sioux Falls"));
+        }, placenameResponse()},
+    };
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: usgsm2m_bench [--url BASE_URL] [--iterations N] [--e2e-iterations N] [--family NAME]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string url;
+    std::string only;
+    int iterations = 2000;
+    int e2eIterations = 200;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) { usage(); return 2; }
+        if (arg == "--url") url = argv[++i];
+        else if (arg == "--iterations") iterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--e2e-iterations") e2eIterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--family") only = argv[++i];
+        else { usage(); return 2; }
+    }
+
+    USGS_M2M_API api;
+    if (!url.empty()) api.setBaseUrl(url);
+
+    std::printf("%-10s %-6s %12s %10s %10s %10s\n", "family", "stage", "ops/s", "p50 us", "p99 us", "allocs/op");
+    for (const Family& family : families()) {
+        if (!only.empty() && family.name != only) continue;
+
+        report(family.name, "build", measure(iterations, [&] {
+            return !api.prepareRequest(family.call).jsonPayload.empty();
+        }));
+        report(family.name, "parse", measure(iterations, [&] {
+            return api.parseJsonResponse(family.response, 200, true).success;
+        }));
+        if (!url.empty()) {
+            report(family.name, "e2e", measure(e2eIterations, [&] { return family.call(api).success; }));
+        }
+    }
+    return 0;
+}
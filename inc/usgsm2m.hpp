@@ -12,12 +12,34 @@
 #include <string>
 #include <optional>
 #include <ctime>
+#include <chrono>
+#include <array>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <string_view>
+#include "usgsm2m_async.hpp"
+#include "usgsm2m_cache.hpp"
+#include "usgsm2m_diskcache.hpp"
+#include "usgsm2m_metrics.hpp"
+#include "usgsm2m_ratelimit.hpp"
+#include "usgsm2m_retry.hpp"
+#include "usgsm2m_timeout.hpp"
+#include "usgsm2m_stream.hpp"
+#include "usgsm2m_transport.hpp"
 
 static const std::string API_URL =  "https://m2m.cr.usgs.gov/api/api/json/stable/";
 
 struct ErrorResponse {
     std::string errorMessage;
     std::optional<int> errorCode;
+    /// @brief errorCode as sent by the M2M API, e.g. RATE_LIMIT, when it is not a number
+    std::optional<std::string> errorCodeName;
 };
 
 struct UserContext {
@@ -25,10 +47,43 @@ struct UserContext {
     std::string ipAddress;
 };
 
+/// @brief Where the time of one request went, from curl's transfer info and the client's own JSON work.
+/// Transfer fields stay zero for requests that were never sent.
+struct RequestTiming {
+    /// @brief DNS resolution
+    std::chrono::microseconds nameLookup{0};
+    /// @brief TCP connect after name resolution
+    std::chrono::microseconds connect{0};
+    /// @brief TLS handshake after the TCP connect, zero for plain HTTP and reused connections
+    std::chrono::microseconds tlsHandshake{0};
+    /// @brief From the start of the request until the first response byte
+    std::chrono::microseconds timeToFirstByte{0};
+    /// @brief From the connection being ready until the first response byte, mostly USGS server time
+    std::chrono::microseconds serverTime{0};
+    /// @brief Whole transfer
+    std::chrono::microseconds total{0};
+    /// @brief Request body bytes sent, after compression
+    long long bytesSent = 0;
+    /// @brief Response body bytes received, before decompression
+    long long bytesReceived = 0;
+    /// @brief Whether the request went out over an existing connection, false if it never got one
+    bool connectionReused = false;
+    /// @brief Serializing the request payload
+    std::chrono::microseconds encode{0};
+    /// @brief Parsing the response body
+    std::chrono::microseconds decode{0};
+    /// @brief Delay asked for by a Retry-After response header, zero if there was none
+    std::chrono::seconds retryAfter{0};
+};
+
 struct MetaDataResponse {
     std::optional<std::string> version;
     int requestId = -1;
     int sessionId = -1;
+    /// @brief Timing of the request that produced the response, zero when served from the cache
+    RequestTiming timing;
+    /// @brief Set when the response came from the response cache or the disk cache without a request
+    bool fromCache = false;
 };
 
 struct DefaultResponse {
@@ -38,6 +93,20 @@ struct DefaultResponse {
     bool success = false;
 };
 
+/// @brief A request produced by an endpoint method without sending it
+struct PreparedRequest {
+    /// @brief Full request URL
+    std::string url;
+    /// @brief JSON body, empty for GET requests
+    std::string jsonPayload;
+    /// @brief Time spent serializing jsonPayload
+    std::chrono::microseconds encodeTime{0};
+    /// @brief Set when the endpoint returned without issuing a request (e.g. argument validation failed)
+    std::optional<DefaultResponse> earlyResponse;
+    /// @brief Downloads requested, charged against the download quota when the request is sent
+    size_t downloadCount = 0;
+};
+
 struct LogoutResponse {
     ErrorResponse errorData;
     bool success = false;
@@ -120,9 +189,177 @@ struct TemporalFilter {
     time_t end;
 };
 
+/// @brief Every sceneSearch parameter except the dataset and paging, used by the paging helpers
+struct SceneSearchOptions {
+    /// @brief Metadata type to return ("summary" or "full")
+    std::optional<std::string> metadataType;
+    std::optional<std::string> sortField;
+    /// @brief Sort direction, either "ASC" or "DESC"
+    std::optional<std::string> sortDirection;
+    std::optional<SortCustomization> sortCustomization;
+    std::optional<bool> useCustomization;
+    std::optional<nlohmann::json> sceneFilter;
+    std::optional<std::string> compareListName;
+    std::optional<std::string> bulkListName;
+    std::optional<std::string> orderListName;
+    std::optional<std::string> excludeListName;
+    std::optional<bool> includeNullMetadataValues;
+};
+
+/// @brief Decoded scene record from sceneSearch, sceneMetadata or a streamed scene
+struct SceneResult {
+    std::string entityId;
+    std::string displayId;
+    std::optional<std::string> orderingId;
+    /// @brief Start of the temporal coverage (UTC), -1 if missing
+    time_t acquisitionDate = -1;
+    /// @brief Publish date (UTC), -1 if missing
+    time_t publishDate = -1;
+    /// @brief Cloud cover in percent, nullopt if unknown
+    std::optional<float> cloudCover;
+    /// @brief Outer ring of the spatial coverage polygon as {longitude, latitude} pairs
+    std::vector<std::array<double, 2>> footprint;
+};
+
+/// @brief Typed sceneSearch response
+struct SceneSearchResponse {
+    std::vector<SceneResult> results;
+    int totalHits = 0;
+    int recordsReturned = 0;
+    /// @brief 1-based index of the next page's first scene, if the server reported one
+    std::optional<int> nextRecord;
+    ErrorResponse errorData;
+    MetaDataResponse metaData;
+    bool success = false;
+};
+
+/// @brief A single metadata field of a scene
+struct SceneMetadataField {
+    std::string id;
+    std::string fieldName;
+    /// @brief Value rendered as a string, empty for null values
+    std::string value;
+};
+
+/// @brief Typed sceneMetadata response
+struct SceneMetadataResponse {
+    SceneResult scene;
+    std::vector<SceneMetadataField> metadata;
+    ErrorResponse errorData;
+    MetaDataResponse metaData;
+    bool success = false;
+};
+
+/// @brief A single item of a scene list
+struct SceneListEntry {
+    std::string entityId;
+    std::string datasetName;
+};
 
+/// @brief Typed sceneListGet response
+struct SceneListResponse {
+    std::vector<SceneListEntry> entries;
+    ErrorResponse errorData;
+    MetaDataResponse metaData;
+    bool success = false;
+};
+
+/// @brief Decode one scene object
+/// @param scene JSON scene as found in sceneSearch results or the sceneMetadata data field
+/// @param out Struct to fill
+/// @return false if the scene has no entityId
+bool decodeSceneResult(const nlohmann::json& scene, SceneResult& out);
+
+/// @brief Decode a sceneSearch response, consuming its data
+/// @param response Response returned by sceneSearch or sceneSearchPage
+/// @return Typed response
+SceneSearchResponse decodeSceneSearchResponse(DefaultResponse&& response);
+
+/// @brief Decode a sceneMetadata response, consuming its data
+/// @param response Response returned by sceneMetadata
+/// @return Typed response
+SceneMetadataResponse decodeSceneMetadataResponse(DefaultResponse&& response);
+
+/// @brief Decode a sceneListGet response, consuming its data
+/// @param response Response returned by sceneListGet
+/// @return Typed response
+SceneListResponse decodeSceneListResponse(DefaultResponse&& response);
+
+/// @brief Scene record whose strings and footprint live in the arena of the SceneArenaResponse holding it
+struct SceneView {
+    std::string_view entityId;
+    std::string_view displayId;
+    /// @brief Empty if the scene has no orderingId
+    std::string_view orderingId;
+    /// @brief Start of the temporal coverage (UTC), -1 if missing
+    time_t acquisitionDate = -1;
+    /// @brief Publish date (UTC), -1 if missing
+    time_t publishDate = -1;
+    /// @brief Cloud cover in percent, nullopt if unknown
+    std::optional<float> cloudCover;
+    /// @brief Outer ring of the spatial coverage polygon as {longitude, latitude} pairs
+    std::pmr::vector<std::array<double, 2>> footprint;
+
+    explicit SceneView(std::pmr::memory_resource* arena) : footprint(arena) {}
+};
+
+/// @brief sceneSearch response decoded straight from the body into a per-response arena.
+/// No JSON DOM is built and every string is a view into the arena, which is released in one
+/// shot when the response is destroyed. Move-only, views stay valid across moves. A moved-from
+/// response has no results and may only be assigned to or destroyed.
+class SceneArenaResponse {
+public:
+    SceneArenaResponse();
+    SceneArenaResponse(SceneArenaResponse&&) = default;
+    SceneArenaResponse& operator=(SceneArenaResponse&&) = default;
+    SceneArenaResponse(const SceneArenaResponse&) = delete;
+    SceneArenaResponse& operator=(const SceneArenaResponse&) = delete;
+
+    /// @brief Scenes of the page, in response order, empty once the response was moved from
+    const std::pmr::vector<SceneView>& results() const;
+
+    int totalHits = 0;
+    int recordsReturned = 0;
+    std::optional<int> nextRecord;
+    ErrorResponse errorData;
+    MetaDataResponse metaData;
+    bool success = false;
+
+    /// @brief Decode a raw sceneSearch body into this response
+    /// @param responseBody The response body
+    /// @param httpCode The HTTP response code
+    /// @param requestSucceeded Whether the transfer itself completed
+    void parse(const std::string& responseBody, long httpCode, bool requestSucceeded);
+
+    /// @brief Copy text into the arena
+    /// @param text Text to copy
+    /// @return View of the copy
+    std::string_view store(const std::string& text);
+
+    /// @brief Start a new scene allocated from the arena
+    /// @return The new scene
+    SceneView& addScene();
+
+private:
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    std::unique_ptr<std::pmr::vector<SceneView>> scenes;
+};
+
+class SceneSearchPager;
+
+/// @brief USGS M2M API client. A single instance may be shared by any number of threads,
+/// each request checks out its own easy handle from an internal pool.
 class USGS_M2M_API {
 public:
+    /// @brief A single endpoint call, e.g. [](USGS_M2M_API& api) { return api.sceneSearch("landsat_ot_c2_l2"); }
+    using ApiCall = std::function<DefaultResponse(USGS_M2M_API&)>;
+
+    /// @brief Callback receiving the response of an asynchronous call
+    using ResponseCallback = std::function<void(DefaultResponse)>;
+
+    /// @brief Callback receiving one streamed record, return false to stop the transfer. A stopped
+    /// stream succeeds without data, since the rest of the response is never read.
+    using RecordCallback = std::function<bool(nlohmann::json&& record)>;
 
     /// @brief Constructor
     USGS_M2M_API();
@@ -689,6 +926,101 @@ public:
         const std::optional<std::string>& excludeListName = std::nullopt
     );
 
+    /// @brief Fetch a single sceneSearch page using a SceneSearchOptions bundle
+    /// @param datasetName Dataset alias to search (required)
+    /// @param maxResults Maximum number of results in the page
+    /// @param startingNumber 1-based index of the first result in the page
+    /// @param options Remaining sceneSearch parameters
+    /// @return DefaultResponse containing the search results
+    DefaultResponse sceneSearchPage(
+        const std::string& datasetName,
+        int maxResults,
+        int startingNumber,
+        const SceneSearchOptions& options = {}
+    );
+
+    /// @brief sceneSearchPage decoded into SceneResult structs
+    /// @param datasetName Dataset alias to search (required)
+    /// @param maxResults Maximum number of results in the page
+    /// @param startingNumber 1-based index of the first result in the page
+    /// @param options Remaining sceneSearch parameters
+    /// @return Typed search results
+    SceneSearchResponse sceneSearchTyped(
+        const std::string& datasetName,
+        int maxResults = 100,
+        int startingNumber = 1,
+        const SceneSearchOptions& options = {}
+    );
+
+    /// @brief sceneSearchPage decoded without a DOM into an arena owned by the response,
+    /// with string_view accessors. Cheapest way to read large pages.
+    /// @param datasetName Dataset alias to search (required)
+    /// @param maxResults Maximum number of results in the page
+    /// @param startingNumber 1-based index of the first result in the page
+    /// @param options Remaining sceneSearch parameters
+    /// @return Arena-backed search results
+    SceneArenaResponse sceneSearchArena(
+        const std::string& datasetName,
+        int maxResults = 100,
+        int startingNumber = 1,
+        const SceneSearchOptions& options = {}
+    );
+
+    /// @brief sceneMetadata decoded into a SceneResult and its metadata fields
+    /// @param datasetName The dataset alias (required)
+    /// @param entityId The scene identifier (required)
+    /// @param metadataType Optional metadata type: "summary", "full", "fgdc", "iso"
+    /// @return Typed scene metadata
+    SceneMetadataResponse sceneMetadataTyped(
+        const std::string& datasetName,
+        const std::string& entityId,
+        const std::optional<std::string>& metadataType = std::nullopt
+    );
+
+    /// @brief sceneListGet decoded into SceneListEntry structs
+    /// @param listId User defined name for the list (required)
+    /// @param datasetName Optional dataset alias
+    /// @param startingNumber Optional starting number to search from
+    /// @param maxResults Optional maximum number of results to return
+    /// @return Typed scene list
+    SceneListResponse sceneListGetTyped(
+        const std::string& listId,
+        const std::optional<std::string>& datasetName = std::nullopt,
+        const std::optional<int>& startingNumber = std::nullopt,
+        const std::optional<int>& maxResults = std::nullopt
+    );
+
+    /// @brief Iterate over every scene matching a search, one record at a time.
+    /// Pages are fetched lazily, and with prefetch the next page is already in flight
+    /// while the current one is consumed. At most two pages are held in memory.
+    /// @param datasetName Dataset alias to search (required)
+    /// @param pageSize Number of scenes requested per page
+    /// @param options Remaining sceneSearch parameters
+    /// @param prefetch Whether to request page N+1 as soon as page N arrives
+    /// @return Range over the individual scene records
+    SceneSearchPager sceneSearchPages(
+        const std::string& datasetName,
+        int pageSize = 100,
+        const SceneSearchOptions& options = {},
+        bool prefetch = true
+    );
+
+    /// @brief Fetch every page of a search concurrently and return all results in one response.
+    /// The first page is fetched alone to learn totalHits, the remaining pages are then
+    /// requested at most maxConcurrentPages at a time and appended to data["results"] in order.
+    /// @param datasetName Dataset alias to search (required)
+    /// @param pageSize Number of scenes requested per page
+    /// @param options Remaining sceneSearch parameters
+    /// @param maxConcurrentPages Maximum number of pages in flight at once
+    /// @return DefaultResponse shaped like a single sceneSearch page holding every result,
+    /// or the error of the first page that failed
+    DefaultResponse sceneSearchParallel(
+        const std::string& datasetName,
+        int pageSize = 100,
+        const SceneSearchOptions& options = {},
+        size_t maxConcurrentPages = 8
+    );
+
     /**********************************  Tram API Functions ***********************************************/
     /// @brief Update a specific metadata detail for an order
     /// @param orderNumber Order ID to update (required)
@@ -751,23 +1083,438 @@ public:
     /// @return DefaultResponse containing unit details for the order
     DefaultResponse tramOrderUnits(const std::string& orderNumber);
 
+    /**********************************  Asynchronous API Functions ***********************************************/
+    /// @brief Run any DefaultResponse endpoint asynchronously on the curl multi event loop.
+    /// The call is executed on the calling thread only to build the request, the transfer itself
+    /// overlaps with every other asynchronous request on a single background thread.
+    /// @param call Lambda invoking exactly one endpoint method on the passed client
+    /// @return Future resolved with the parsed response
+    std::future<DefaultResponse> submitAsync(const ApiCall& call);
+
+    /// @brief Run any DefaultResponse endpoint asynchronously and deliver the response to a callback.
+    /// The callback runs on the event loop thread, or on the calling thread if no request was sent.
+    /// @param call Lambda invoking exactly one endpoint method on the passed client
+    /// @param onComplete Callback receiving the parsed response
+    void submitAsync(const ApiCall& call, ResponseCallback onComplete);
+
+    /// @brief Build the request an endpoint call would send, without sending it
+    /// @param call Lambda invoking exactly one endpoint method on the passed client
+    /// @return The prepared request, or earlyResponse if the endpoint returned before sending
+    PreparedRequest prepareRequest(const ApiCall& call);
+
+    /// @brief Set the maximum number of asynchronous requests in flight at once
+    /// @param maxRequests Maximum concurrent transfers (default 32)
+    void setMaxConcurrentRequests(size_t maxRequests);
+
+    /// @brief Opt in to HTTP/2. Requests negotiate h2 when the server supports it (HTTP/1.1 otherwise),
+    /// and concurrent asynchronous and blocking calls are multiplexed as streams over at most
+    /// maxConnections connections instead of opening one connection each.
+    /// @param enabled Whether HTTP/2 multiplexing is used
+    /// @param maxConnections Maximum connections per host while enabled (default 1)
+    /// @return false if the linked libcurl was built without HTTP/2 support
+    bool setHttp2Multiplexing(bool enabled, long maxConnections = 1);
+
+    /// @brief Set how many idle easy handles are kept for reuse by blocking and asynchronous calls
+    /// @param maxIdleHandles Number of idle handles kept (default 8)
+    void setHandlePoolSize(size_t maxIdleHandles);
+
+    /// @brief Set how many response buffers are kept for reuse and how large a kept buffer may be
+    /// @param maxIdleBuffers Number of idle buffers kept (default 8)
+    /// @param maxBufferBytes Buffers that grew larger are freed after their request (default 1 MiB)
+    void setResponseBufferRetention(size_t maxIdleBuffers, size_t maxBufferBytes);
+
+    /**********************************  Streaming API Functions ***********************************************/
+    /// @brief Send an endpoint call and stream the elements of an array in its response to a callback
+    /// as the bytes arrive, without holding the body or a DOM of it.
+    /// @param call Lambda invoking exactly one endpoint method on the passed client
+    /// @param arrayPaths Object keys leading to the array to stream, e.g. {{"data", "results"}}, "*" matches any key
+    /// @param onRecord Callback receiving each element
+    /// @return The response with the streamed array left empty, or a successful response without data if
+    /// onRecord stopped the stream
+    DefaultResponse streamRecords(
+        const ApiCall& call,
+        const std::vector<std::vector<std::string>>& arrayPaths,
+        const RecordCallback& onRecord
+    );
+
+    /// @brief Fetch one sceneSearch page, streaming each scene of data.results to a callback
+    /// @param datasetName Dataset alias to search (required)
+    /// @param maxResults Maximum number of results in the page
+    /// @param startingNumber 1-based index of the first result in the page
+    /// @param options Remaining sceneSearch parameters
+    /// @param onRecord Callback receiving each scene
+    /// @return The response with data.results left empty
+    DefaultResponse sceneSearchStreaming(
+        const std::string& datasetName,
+        int maxResults,
+        int startingNumber,
+        const SceneSearchOptions& options,
+        const RecordCallback& onRecord
+    );
+
+    /// @brief Retrieve metadata for a scene list, streaming each scene to a callback
+    /// @param listId The scene list identifier (required)
+    /// @param onRecord Callback receiving each scene
+    /// @param datasetName Optional dataset alias
+    /// @param metadataType Optional metadata type: "summary" or "full"
+    /// @param includeNullMetadataValues Optional flag to include null metadata values
+    /// @param useCustomization Optional flag to display metadata as per user customization
+    /// @return The response with the scene arrays left empty
+    DefaultResponse sceneMetadataListStreaming(
+        const std::string& listId,
+        const RecordCallback& onRecord,
+        const std::optional<std::string>& datasetName = std::nullopt,
+        const std::optional<std::string>& metadataType = std::nullopt,
+        const std::optional<bool>& includeNullMetadataValues = std::nullopt,
+        const std::optional<bool>& useCustomization = std::nullopt
+    );
+
+    /**********************************  Response Parsing ***********************************************/
+    /// @brief Turn a raw response body into a DefaultResponse. The data subtree is moved out of
+    /// the parsed document, the response is never deep-copied.
+    /// @param responseBody The response body
+    /// @param httpCode The HTTP response code
+    /// @param requestSucceeded Whether the transfer itself completed
+    /// @return struct representing the response.
+    DefaultResponse parseJsonResponse(const std::string& responseBody, long httpCode, bool requestSucceeded);
+
+    /**********************************  Metrics ***********************************************/
+    /// @brief Per-endpoint request counts, error counts, bytes and latency histograms of every
+    /// request this client has sent
+    /// @return Point-in-time copy of the metrics
+    MetricsSnapshot metricsSnapshot() const;
+
+    /// @brief metricsSnapshot rendered in the Prometheus text exposition format
+    /// @return Prometheus text, ready to be served on a /metrics endpoint
+    std::string metricsPrometheus() const;
+
+    /**********************************  Rate Limiting ***********************************************/
+    /// @brief Pace every request with a token bucket. Pacing also starts on its own at the first
+    /// HTTP 429 or RATE_LIMIT error, from the rate requests were being sent at.
+    /// Limit errors halve the rate and successes raise it back towards the ceiling.
+    /// @param requestsPerSecond Sustained request rate, 0 to stop pacing
+    /// @param burst Requests that may be sent at once
+    void setRateLimit(double requestsPerSecond, double burst = 1);
+
+    /// @brief Seed the download quota from rateLimitSummary. The summary reports download counts,
+    /// not request rates: downloadRequest is then held back so that the downloads it asks for never
+    /// exceed the remaining recentDownloadCount, refilling at the initial limit per quotaWindow.
+    /// @param quotaWindow Period the recent download counts of the summary cover
+    /// @return The rateLimitSummary response, unsuccessful if it reported no download limit
+    DefaultResponse configureRateLimitFromSummary(std::chrono::seconds quotaWindow = std::chrono::minutes(15));
+
+    /// @brief Current state of the request pacing
+    RateLimitState rateLimitState() const;
+
+    /// @brief Current state of the download quota seeded by configureRateLimitFromSummary
+    RateLimitState downloadQuotaState() const;
+
+    /**********************************  Retries ***********************************************/
+    /// @brief Retry transient failures of blocking, asynchronous, streamed and arena requests.
+    /// Streamed requests are only retried while no record has been delivered yet.
+    /// Requests already in flight keep the policy they started with.
+    /// @param policy The policy, maxAttempts 1 (the default) disables retries
+    void setRetryPolicy(const RetryPolicy& policy);
+
+    /// @brief Get the current retry policy
+    RetryPolicy getRetryPolicy() const;
+
+    /**********************************  Timeouts ***********************************************/
+    /// @brief Set the time limits of every request attempt, 10 seconds total by default.
+    /// A RequestDeadline in scope further bounds each attempt, its retries and its pages.
+    /// @param timeouts Limits used by endpoints without an override
+    void setTimeouts(const TimeoutConfig& timeouts);
+
+    /// @brief Get the time limits used by endpoints without an override
+    TimeoutConfig getTimeouts() const;
+
+    /// @brief Override the time limits of one endpoint, e.g. a long total for "scene-metadata-list"
+    /// @param endpoint Endpoint name, e.g. "dataset-coverage"
+    /// @param timeouts Limits of that endpoint
+    void setEndpointTimeouts(const std::string& endpoint, const TimeoutConfig& timeouts);
+
+    /// @brief Remove the override of an endpoint
+    /// @param endpoint Endpoint name
+    void clearEndpointTimeouts(const std::string& endpoint);
+
+    /**********************************  Compression ***********************************************/
+    /// @brief Ask for compressed responses (Accept-Encoding with every encoding the linked libcurl
+    /// supports, e.g. gzip, deflate, zstd or br). Responses are decoded incrementally as they
+    /// arrive, streamed and arena requests see the decoded bytes. On by default.
+    /// @param enabled Whether responses are negotiated compressed
+    void setResponseCompression(bool enabled);
+
+    /// @brief gzip request bodies of at least minBytes and send them with Content-Encoding: gzip,
+    /// e.g. large sceneListAdd entity ID arrays. Off by default, the server has to accept it.
+    /// @param minBytes Smallest body that is compressed, 0 disables request compression
+    /// @param level zlib level from 1 (fastest) to 9 (smallest), -1 for zlib's default
+    void setRequestCompression(size_t minBytes, int level = -1);
+
+    /**********************************  Response Cache ***********************************************/
+    /// @brief Serve repeated calls of rarely changing lookup endpoints (dataset, dataset-filters,
+    /// grid2ll, placename, permissions, ...) from memory. Blocking and asynchronous calls with the
+    /// same endpoint and parameters get the cached response until its time to live runs out.
+    /// The cache is emptied by setAuthToken and setBaseUrl. Off until called.
+    /// @param config Size bound, time to live and cached endpoints
+    void setResponseCache(const ResponseCacheConfig& config = ResponseCacheConfig());
+
+    /// @brief Stop caching and drop every cached response
+    void disableResponseCache();
+
+    /// @brief Drop every cached response, e.g. after changing dataset customizations
+    void clearResponseCache();
+
+    /// @brief Hits, misses, evictions and size of the response cache
+    ResponseCacheStats responseCacheStats() const;
+
+    /**********************************  Disk Cache ***********************************************/
+    /// @brief Keep responses of static metadata endpoints (dataset-filters, dataset-file-groups,
+    /// scene-metadata, ...) in a directory shared by every process on the node, so restarted jobs
+    /// start warm. Consulted after the in-memory response cache, entries are keyed by the full
+    /// request URL and body and are shared by every user of the directory.
+    /// @param config Directory, size bound, time to live and cached endpoints
+    /// @return false if the directory could not be opened, the disk cache is then off
+    bool setDiskCache(const DiskCacheConfig& config);
+
+    /// @brief Stop using the disk cache, its files are kept
+    void disableDiskCache();
+
+    /// @brief Delete every response in the disk cache, for every process using it
+    void clearDiskCache();
+
+    /// @brief Hits and misses of this client and the size of the disk cache
+    DiskCacheStats diskCacheStats() const;
+
+    /**********************************  Endpoint Configuration ***********************************************/
+    /// @brief Point the client at another M2M deployment, e.g. a local stand-in server.
+    /// Requests already in flight keep the URL they started with.
+    /// @param url Base URL the endpoint names are appended to, a trailing '/' is added if missing
+    void setBaseUrl(const std::string& url);
+
+    /// @brief Get the base URL requests are sent to (API_URL unless changed)
+    std::string getBaseUrl() const;
+
+    /// @brief Record every successful response body to directory/<endpoint>.json, overwriting the
+    /// previous recording of that endpoint. The files can be served by the m2m_standin tool.
+    /// Streamed responses are not recorded.
+    /// @param directory Existing directory to write to, empty to stop recording
+    void setResponseRecorder(const std::string& directory);
+
     /**********************************  HTTP Header Updating functions ***********************************************/
     /// @brief Set the X-Auth-Token header
     /// @param token The authentication token to be used in the request
     void setAuthToken(const std::string& token);
 
-    /// @brief Updates the header list with a new header or modifies an existing one
+    /// @brief Updates the header list with a new header or modifies an existing one.
+    /// Requests already in flight keep the header set they started with.
     /// @param header 
     void updateHeader(const std::string& header);
 
 private:
-    /// @brief CURL handle
-    CURL *curl = nullptr;
-    /// @brief CURL headers
-    struct curl_slist *headers = nullptr;
-
-    /// @brief headers vector for all headers
-    std::vector<std::string> headersVector;
+    /// @brief Reusable easy handles shared by every thread, attached to the process-wide cache
+    CurlHandlePool handlePool{8, &CurlShareCache::instance()};
+    /// @brief Recycled response bodies, pre-sized from earlier responses of each endpoint
+    ResponseBufferPool responseBuffers;
+    /// @brief Responses of cacheable lookup endpoints
+    ResponseCache responseCache;
+
+    /// @brief Disk cache in use, nullptr when off
+    std::shared_ptr<DiskCache> diskCache;
+    /// @brief Guards swapping and reading the disk cache
+    mutable std::mutex diskCacheMutex;
+
+    /// @brief Get the disk cache in use, kept alive by the caller for the duration of its lookup
+    std::shared_ptr<DiskCache> currentDiskCache() const;
+
+    /// @brief Look a request up in the response cache, then in the disk cache
+    /// @param url Full request URL, its last path segment names the endpoint
+    /// @param payload Request body
+    /// @return Copy of the cached response marked fromCache, nullopt on a miss or if not cacheable
+    std::optional<DefaultResponse> cachedResponse(const std::string& url, const std::string& payload);
+
+    /// @brief Keep a successful response in the caches its endpoint is cached by
+    /// @param url Full request URL
+    /// @param payload Request body
+    /// @param response The parsed response
+    /// @param responseBody The raw response body
+    void cacheResponse(const std::string& url, const std::string& payload, const DefaultResponse& response,
+        const std::string& responseBody);
+
+    /// @brief Current header set, replaced as a whole by updateHeader
+    std::shared_ptr<const HeaderSet> headers;
+    /// @brief Guards swapping and reading the header set
+    mutable std::mutex headersMutex;
+
+    /// @brief Get the header set current at the time of the call
+    /// @return Shared header set, kept alive by the caller for the duration of its request
+    std::shared_ptr<const HeaderSet> currentHeaders() const;
+
+    /// @brief Base URL endpoint names are appended to
+    std::string baseUrl = API_URL;
+    /// @brief Directory responses are recorded to, empty when not recording
+    std::string recordDirectory;
+    /// @brief Time limits of endpoints without an override
+    TimeoutConfig defaultTimeouts;
+    /// @brief Time limits by endpoint name
+    std::map<std::string, TimeoutConfig> endpointTimeouts;
+    /// @brief Guards baseUrl, recordDirectory and the timeouts
+    mutable std::mutex endpointMutex;
+
+    /// @brief Time limits of an endpoint
+    /// @param url Full request URL, its last path segment names the endpoint
+    TimeoutConfig timeoutsFor(const std::string& url) const;
+
+    /// @brief Apply the time limits of an endpoint to an easy handle, shortened to fit the deadline
+    /// @param handle The easy handle to configure
+    /// @param url Full request URL
+    /// @param deadline Deadline of the request, if any
+    /// @param startAt When the transfer will start
+    void applyTimeouts(CURL* handle, const std::string& url, std::optional<RequestDeadline::Clock::time_point> deadline,
+        RequestDeadline::Clock::time_point startAt);
+
+    /// @brief Error of a request that could not be sent before its deadline
+    static ErrorResponse deadlineExceeded();
+
+    /// @brief Aggregated request metrics, recorded without locking
+    MetricsRegistry metrics;
+
+    /// @brief Count a completed request in the metrics
+    /// @param url Full request URL, its last path segment names the endpoint
+    /// @param timing Timing of the request
+    /// @param errorData Error of a failed request
+    /// @param success Whether the request succeeded
+    void recordMetrics(const std::string& url, const RequestTiming& timing, const ErrorResponse& errorData, bool success);
+
+    /// @brief Full URL of an endpoint under the current base URL
+    /// @param endpoint Endpoint name, e.g. "scene-search"
+    std::string endpointUrl(const std::string& endpoint) const;
+
+    /// @brief Write a response to the recorder directory if recording is on
+    /// @param url Full request URL, its last path segment names the recording
+    /// @param responseBody The response body
+    /// @param httpCode The HTTP response code, only 200 responses are recorded
+    void recordResponse(const std::string& url, const std::string& responseBody, long httpCode) const;
+
+    /// @brief Paces every request
+    RateLimiter requestLimiter;
+    /// @brief Paces the downloads asked for by downloadRequest
+    RateLimiter downloadLimiter;
+
+    /// @brief Reservations of one request on both limiters
+    struct SendSlot {
+        RateLimiter::Reservation request;
+        RateLimiter::Reservation downloads;
+        /// @brief Earliest time the request may be sent
+        RateLimiter::Clock::time_point at{};
+    };
+
+    /// @brief Reserve the next send slot of a request
+    /// @param downloadCount Downloads the request asks for
+    /// @return The slot
+    SendSlot reserveSendSlot(size_t downloadCount);
+
+    /// @brief Give back the tokens of a send slot that will not be used
+    void cancelSendSlot(const SendSlot& slot);
+
+    /// @brief Whether a limit error since the reservation wrote the slot off, so the request has to
+    /// reserve again at the lowered rate
+    bool sendSlotStale(const SendSlot& slot) const;
+
+    /// @brief Reserve the next send slot and sleep until it comes, reserving again if a limit error
+    /// writes the slot off meanwhile
+    /// @param downloadCount Downloads the request asks for
+    /// @param deadline Deadline of the request, if any
+    /// @return false without sleeping if the slot comes after the deadline
+    bool waitForSendSlot(size_t downloadCount = 0,
+        std::optional<RequestDeadline::Clock::time_point> deadline = RequestDeadline::current());
+
+    /// @brief Adapt the request pacing to the outcome of a request
+    /// @param httpCode The HTTP response code
+    /// @param errorData Error of the parsed response
+    /// @param timing Timing of the request, for the Retry-After delay
+    void observeRateLimit(long httpCode, const ErrorResponse& errorData, const RequestTiming& timing);
+
+    /// @brief Current retry policy, replaced as a whole by setRetryPolicy
+    std::shared_ptr<const RetryPolicy> retryPolicy = std::make_shared<const RetryPolicy>();
+    /// @brief Guards swapping and reading the retry policy
+    mutable std::mutex retryMutex;
+    /// @brief Retries left to spend, shared by every request of this client
+    RetryBudget retryBudget;
+
+    /// @brief Get the retry policy current at the time of the call
+    std::shared_ptr<const RetryPolicy> currentRetryPolicy() const;
+
+    /// @brief Decide whether a finished attempt is sent again, spending the retry budget if so
+    /// @param policy Policy of the request
+    /// @param url Full request URL, its last path segment names the endpoint
+    /// @param attempt Attempts made so far, including this one
+    /// @param result Transfer result reported by curl
+    /// @param httpCode The HTTP response code
+    /// @param success Whether the parsed response succeeded
+    /// @param errorData Error of the parsed response
+    /// @param timing Timing of the attempt, for the Retry-After delay
+    /// @param deadline Deadline of the request, no retry is scheduled past it
+    /// @return Delay before the next attempt, nullopt to return the response as it is
+    std::optional<std::chrono::milliseconds> retryDelay(const RetryPolicy& policy, const std::string& url, int attempt,
+        CURLcode result, long httpCode, bool success, const ErrorResponse& errorData, const RequestTiming& timing,
+        std::optional<RequestDeadline::Clock::time_point> deadline);
+
+    /// @brief Event loop for asynchronous requests, created on first use
+    std::unique_ptr<CurlMultiEngine> engine;
+    /// @brief Guards lazy creation of the event loop
+    std::once_flag engineOnce;
+    /// @brief Maximum concurrent asynchronous transfers
+    std::atomic<size_t> maxConcurrentRequests{32};
+    /// @brief Whether requests negotiate HTTP/2 and share multiplexed connections
+    std::atomic<bool> http2Multiplexing{false};
+    /// @brief Whether responses are negotiated compressed
+    std::atomic<bool> responseCompression{true};
+    /// @brief Smallest request body that is gzipped, 0 when request compression is off
+    std::atomic<size_t> requestCompressionMinBytes{0};
+    /// @brief zlib level of compressed request bodies
+    std::atomic<int> requestCompressionLevel{-1};
+
+    /// @brief gzip a request body
+    /// @param input Body to compress
+    /// @param output Compressed body (output)
+    /// @param level zlib compression level
+    /// @return false if zlib failed
+    static bool gzipCompress(const std::string& input, std::string& output, int level);
+    /// @brief Connection limit per host while multiplexing
+    std::atomic<long> http2MaxConnections{1};
+
+    /// @brief Request being captured by prepareRequest on this thread, nullptr otherwise
+    static thread_local std::optional<PreparedRequest>* requestCapture;
+
+    /// @brief Get the asynchronous event loop, creating it if needed
+    /// @return The event loop
+    CurlMultiEngine& asyncEngine();
+
+    /// @brief State of one asynchronous request across its attempts
+    struct AsyncTransfer;
+
+    /// @brief Send one attempt of an asynchronous request, scheduling the next one if it fails transiently
+    /// @param transfer The request
+    /// @param notBefore The attempt is not sent before this point
+    void startAsyncAttempt(const std::shared_ptr<AsyncTransfer>& transfer, std::chrono::steady_clock::time_point notBefore);
+
+    /// @brief Run a configured transfer to completion, through the event loop when multiplexing
+    /// @param handle The configured easy handle
+    /// @return The transfer result
+    CURLcode executeTransfer(CURL* handle);
+
+    /// @brief Apply the options shared by every JSON request to an easy handle
+    /// @param handle The easy handle to configure
+    /// @param url The URL to send the request to
+    /// @param jsonPayload The JSON payload, empty for a GET request
+    /// @param responseBody The response body (output)
+    /// @param requestHeaders The header set to send
+    /// @param deadline Deadline of the request, if any
+    /// @param startAt When the transfer will start, later than now if it waits for the rate limiter
+    void configureJsonRequest(CURL* handle, const std::string& url, const std::string& jsonPayload,
+        std::string& responseBody, const HeaderSet& requestHeaders,
+        std::optional<RequestDeadline::Clock::time_point> deadline,
+        RequestDeadline::Clock::time_point startAt = RequestDeadline::Clock::now());
 
     /// @brief Callback function for CURL write
     /// @param contents Pointer to the data
@@ -777,22 +1524,41 @@ private:
     /// @return Number of bytes processed
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
 
+    /// @brief Callback function for CURL headers, reserves the response body from Content-Length
+    /// @param buffer Pointer to the header line, not null-terminated
+    /// @param size Always 1
+    /// @param nitems Length of the header line
+    /// @param userdata The response body string, nullptr if the body is not buffered
+    /// @return Number of bytes processed
+    static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata);
+
     /// @brief Perform a JSON POST request
     /// @param url The URL to send the request to
     /// @param jsonPayload The JSON payload to send
     /// @param responseBody The response body (output)
     /// @param httpCodeOut The HTTP response code (output)
+    /// @param timing Transfer timing (output, optional)
+    /// @param curlResult Transfer result reported by curl (output, optional)
     /// @return true if the request was successful, false otherwise
-    bool performJsonPostRequest(const std::string& url, const std::string& jsonPayload, std::string& responseBody, long& httpCodeOut);
+    bool performJsonPostRequest(const std::string& url, const std::string& jsonPayload, std::string& responseBody, long& httpCodeOut,
+        RequestTiming* timing = nullptr, CURLcode* curlResult = nullptr);
 
     /// @brief Perform a JSON GET request
     /// @param url The URL to send the request to
     /// @param responseBody The response body (output)
     /// @param httpCodeOut The HTTP response code (output)
+    /// @param timing Transfer timing (output, optional)
+    /// @param curlResult Transfer result reported by curl (output, optional)
     /// @return true if the request was successful, false otherwise
-    bool performJsonGetRequest(const std::string& url, std::string& responseBody, long& httpCodeOut);
+    bool performJsonGetRequest(const std::string& url, std::string& responseBody, long& httpCodeOut,
+        RequestTiming* timing = nullptr, CURLcode* curlResult = nullptr);
+
+    /// @brief Copy the transfer timing of a finished easy handle, leaving encode and decode untouched
+    /// @param handle The easy handle after the transfer
+    /// @param timing Timing to fill
+    static void collectTiming(CURL* handle, RequestTiming& timing);
 
-    /// @brief Setup CURL
+    /// @brief Setup CURL and the default headers
     void setup_curl();
 
     /// @brief Cleanup CURLs
@@ -819,10 +1585,19 @@ private:
     void jsonMetaDataParsing(nlohmann::json& jsonResponse, MetaDataResponse& metaData);
 
     /// @brief Common JSON response parsing for defaultResponse types
-    /// @param responseBody The response body
+    /// @param endpoint The endpoint name, appended to the base URL
     /// @param jsonPayload The JSON payload to send (optional, for POST requests)
+    /// @param encodeTime Time it took to serialize jsonPayload
+    /// @param downloadCount Downloads the request asks for, charged against the download quota
+    /// @return struct representing the response.
+    DefaultResponse defaultJsonResponseParsing(const std::string& endpoint, const std::string& jsonPayload = "",
+        std::chrono::microseconds encodeTime = std::chrono::microseconds{0}, size_t downloadCount = 0);
+
+    /// @brief Serialize the payload, timing it, and send it as a POST request
+    /// @param endpoint The endpoint name, appended to the base URL
+    /// @param payload The JSON payload to send
     /// @return struct representing the response.
-    DefaultResponse defaultJsonResponseParsing(const std::string& url, nlohmann::json& jsonResponse, const std::string& jsonPayload = "");
+    DefaultResponse defaultJsonResponseParsing(const std::string& endpoint, const nlohmann::json& payload);
 
     /// @brief Safely get an optional integer from a JSON object
     /// @param j JSON object
@@ -847,4 +1622,90 @@ private:
     std::string timeToISO8601UTC(time_t t);
 };
 
+/// @brief Input range over the scene records of a sceneSearch spanning any number of pages.
+/// Iteration stops at the last page or at the first failed page, check success() afterwards.
+class SceneSearchPager {
+public:
+    /// @brief Single pass iterator yielding one scene record per step
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = nlohmann::json;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const nlohmann::json*;
+        using reference = const nlohmann::json&;
+
+        iterator() = default;
+        explicit iterator(SceneSearchPager* pager) : pager(pager) {}
+
+        reference operator*() const { return pager->current(); }
+        pointer operator->() const { return &pager->current(); }
+        iterator& operator++() {
+            if (!pager->advance()) pager = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return pager == other.pager; }
+        bool operator!=(const iterator& other) const { return pager != other.pager; }
+
+    private:
+        SceneSearchPager* pager = nullptr;
+    };
+
+    /// @brief Constructor, nothing is requested until begin() is called
+    /// @param api Client used for every page, must outlive the pager
+    /// @param datasetName Dataset alias to search
+    /// @param pageSize Number of scenes requested per page
+    /// @param options Remaining sceneSearch parameters
+    /// @param prefetch Whether to request page N+1 as soon as page N arrives
+    SceneSearchPager(USGS_M2M_API& api, std::string datasetName, int pageSize,
+        SceneSearchOptions options, bool prefetch);
+
+    /// @brief Fetch the first page and point at its first record
+    /// @return Iterator at the first record, end() if there is none
+    iterator begin();
+
+    /// @brief Past-the-end iterator
+    iterator end() { return iterator(); }
+
+    /// @brief Whether every page fetched so far succeeded
+    bool success() const { return ok; }
+
+    /// @brief Error of the page that stopped the iteration
+    const ErrorResponse& error() const { return errorData; }
+
+    /// @brief totalHits reported by the first page, if any
+    std::optional<int> totalHits() const { return hits; }
+
+private:
+    /// @brief Record the iterator currently points at
+    const nlohmann::json& current() const { return results[index]; }
+
+    /// @brief Step to the next record, fetching pages as needed
+    /// @return false when there are no more records
+    bool advance();
+
+    /// @brief Wait for the page starting at nextStart and make it current
+    /// @return false when the page failed or was empty
+    bool loadNextPage();
+
+    /// @brief Start fetching the page at nextStart in the background
+    void prefetchNextPage();
+
+    USGS_M2M_API& api;
+    std::string datasetName;
+    int pageSize;
+    SceneSearchOptions options;
+    bool prefetch;
+
+    /// @brief Results array of the current page
+    nlohmann::json results = nlohmann::json::array();
+    size_t index = 0;
+    /// @brief 1-based startingNumber of the next page, nullopt once the last page was seen
+    std::optional<int> nextStart = 1;
+    std::optional<std::future<DefaultResponse>> pendingPage;
+    std::optional<int> hits;
+    bool ok = true;
+    ErrorResponse errorData;
+};
+
 #endif //USGSM2M_HPP
\ No newline at end of file
@@ -0,0 +1,101 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief curl multi event loop used by the asynchronous USGS M2M API calls
+
+
+#ifndef USGSM2M_ASYNC_HPP
+#define USGSM2M_ASYNC_HPP
+
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+/// @brief Drives any number of easy handles on a single background thread using curl_multi
+class CurlMultiEngine {
+public:
+    /// @brief Called on the engine thread once a transfer has finished
+    /// @param handle The easy handle that was submitted
+    /// @param result The transfer result reported by curl
+    using Completion = std::function<void(CURL* handle, CURLcode result)>;
+
+    /// @brief Called on the engine thread right before a transfer is attached, e.g. to pace it again
+    /// @param handle The easy handle that was submitted, not attached yet
+    /// @return When the transfer may start: a later time queues it again, time_point::max() fails it
+    /// with CURLE_OPERATION_TIMEDOUT, anything else starts it now
+    using StartCheck = std::function<std::chrono::steady_clock::time_point(CURL* handle)>;
+
+    /// @brief Constructor
+    /// @param maxInFlight Maximum number of transfers attached to the multi handle at once
+    explicit CurlMultiEngine(size_t maxInFlight = 32);
+
+    /// @brief Destructor, aborts every queued and running transfer
+    ~CurlMultiEngine();
+
+    CurlMultiEngine(const CurlMultiEngine&) = delete;
+    CurlMultiEngine& operator=(const CurlMultiEngine&) = delete;
+
+    /// @brief Queue a fully configured easy handle for transfer
+    /// @param handle The easy handle, owned by the caller until onDone runs
+    /// @param onDone Completion invoked on the engine thread
+    /// @param notBefore The transfer is not started before this point, e.g. a rate limiter slot
+    /// @param check Asked again whenever the transfer is about to start, optional
+    void submit(CURL* handle, Completion onDone, std::chrono::steady_clock::time_point notBefore = {},
+        StartCheck check = nullptr);
+
+    /// @brief Change the maximum number of concurrent transfers
+    /// @param maxInFlight New limit, at least 1
+    void setMaxInFlight(size_t maxInFlight);
+
+    /// @brief Limit the number of connections opened per host, 0 for no limit.
+    /// With HTTP/2 multiplexing the remaining transfers become streams on the open connections.
+    /// @param maxConnections Connection limit per host
+    void setMaxHostConnections(long maxConnections);
+
+    /// @brief Whether the calling thread is the event loop thread
+    /// @return true when called from a completion callback
+    bool onEngineThread() const;
+
+private:
+    struct Transfer {
+        CURL* handle = nullptr;
+        Completion onDone;
+        StartCheck check;
+    };
+
+    /// @brief Event loop body
+    void run();
+
+    /// @brief Move queued transfers into the multi handle while below the limit
+    void attachPending();
+
+    /// @brief Time until the next delayed transfer is due, capped at the idle poll interval
+    int pollTimeoutMs();
+
+    /// @brief Apply option changes to the multi handle from the engine thread
+    void applyMultiOptions();
+
+    /// @brief Hand finished transfers to their completions
+    void collectFinished();
+
+    CURLM* multi = nullptr;
+    std::thread worker;
+    /// @brief Id of the worker thread, readable without the lock
+    std::atomic<std::thread::id> workerId{};
+    std::mutex mutex;
+    std::deque<Transfer> pending;
+    /// @brief Transfers submitted with a start time still in the future, by start time
+    std::multimap<std::chrono::steady_clock::time_point, Transfer> delayed;
+    std::map<CURL*, Completion> running;
+    size_t maxInFlight;
+    long maxHostConnections = 0;
+    /// @brief Set when maxHostConnections must be applied to the multi handle
+    bool multiOptionsChanged = false;
+    bool stopping = false;
+};
+
+#endif //USGSM2M_ASYNC_HPP
@@ -0,0 +1,106 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief In-memory response cache of the USGS M2M API client
+
+
+#ifndef USGSM2M_CACHE_HPP
+#define USGSM2M_CACHE_HPP
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct DefaultResponse;
+
+/// @brief What the response cache keeps and for how long
+struct ResponseCacheConfig {
+    /// @brief Response bytes kept before the least recently used entries are evicted, 0 disables the cache
+    size_t maxBytes = 16 << 20;
+    /// @brief How long a response is served from the cache
+    std::chrono::seconds ttl{300};
+    /// @brief Endpoints whose successful responses are cached, all of them lookups of rarely changing data
+    std::set<std::string, std::less<>> endpoints{
+        "dataset", "dataset-browse", "dataset-catalogs", "dataset-categories", "dataset-coverage",
+        "dataset-file-groups", "dataset-filters", "dataset-metadata", "grid2ll", "permissions", "placename"};
+};
+
+/// @brief Point-in-time counters of a ResponseCache
+struct ResponseCacheStats {
+    /// @brief Lookups answered from the cache
+    unsigned long long hits = 0;
+    /// @brief Lookups of cacheable endpoints that went to the server
+    unsigned long long misses = 0;
+    /// @brief Entries dropped to stay within maxBytes
+    unsigned long long evictions = 0;
+    /// @brief Entries currently held
+    size_t entries = 0;
+    /// @brief Bytes currently held, counted as response body plus key size
+    size_t bytes = 0;
+};
+
+/// @brief Size-bounded LRU cache of successful responses with a time to live, keyed by endpoint
+/// and request body. Request bodies are serialized from JSON objects with sorted keys, so equal
+/// requests produce the same key. Thread-safe.
+class ResponseCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Replace the configuration, dropping every entry
+    /// @param config The new configuration
+    /// @param enable Whether the cache is used at all
+    void configure(const ResponseCacheConfig& config, bool enable);
+
+    /// @brief Whether responses of an endpoint are cached
+    /// @param endpoint Endpoint name, e.g. "dataset-filters"
+    bool cacheable(std::string_view endpoint) const;
+
+    /// @brief Find a fresh response, counting a hit or a miss
+    /// @param endpoint Endpoint name
+    /// @param payload Request body, empty for GET requests
+    /// @return The cached response, nullptr on a miss
+    std::shared_ptr<const DefaultResponse> lookup(std::string_view endpoint, const std::string& payload);
+
+    /// @brief Keep a successful response, evicting the least recently used ones if needed
+    /// @param endpoint Endpoint name
+    /// @param payload Request body
+    /// @param response The response
+    /// @param responseBytes Size of the response body
+    void store(std::string_view endpoint, const std::string& payload, const DefaultResponse& response,
+        size_t responseBytes);
+
+    /// @brief Drop every entry
+    void clear();
+
+    /// @brief Current counters
+    ResponseCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const DefaultResponse> response;
+        size_t bytes = 0;
+        Clock::time_point expires;
+    };
+
+    /// @brief Remove an entry, the caller holds the lock
+    void erase(std::list<Entry>::iterator entry);
+
+    mutable std::mutex mutex;
+    bool enabled = false;
+    ResponseCacheConfig config;
+    /// @brief Most recently used first
+    std::list<Entry> entries;
+    /// @brief Entries by key, the views point into the keys of the list nodes
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long evictions = 0;
+};
+
+#endif //USGSM2M_CACHE_HPP
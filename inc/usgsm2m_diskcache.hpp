@@ -0,0 +1,118 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Persistent response cache of the USGS M2M API client, shared by every process on a node
+
+
+#ifndef USGSM2M_DISKCACHE_HPP
+#define USGSM2M_DISKCACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+
+/// @brief Where the disk cache lives and what it keeps
+struct DiskCacheConfig {
+    /// @brief Cache directory, created if missing. Every process using it shares the cached responses.
+    std::string directory;
+    /// @brief Bytes of segment files kept before the oldest segment is dropped
+    size_t maxBytes = 256 << 20;
+    /// @brief How long a stored response is served
+    std::chrono::seconds ttl{24 * 60 * 60};
+    /// @brief Index slots of a newly created cache, an existing cache keeps its own
+    uint32_t slots = 1 << 16;
+    /// @brief Endpoints whose successful responses are stored. Entries are shared by every user of
+    /// the directory, so only list endpoints whose responses do not depend on the user.
+    std::set<std::string, std::less<>> endpoints{
+        "dataset", "dataset-file-groups", "dataset-filters", "dataset-metadata", "scene-metadata"};
+};
+
+/// @brief Point-in-time counters of a DiskCache
+struct DiskCacheStats {
+    /// @brief Lookups of this process answered from disk
+    unsigned long long hits = 0;
+    /// @brief Lookups of this process that found nothing fresh
+    unsigned long long misses = 0;
+    /// @brief Live index entries, across every process
+    unsigned long long entries = 0;
+    /// @brief Bytes in segment files, including overwritten records not yet evicted
+    unsigned long long bytes = 0;
+};
+
+/// @brief Cache of response bodies in a directory, shared across processes.
+/// A memory-mapped open-addressing hash index points into append-only segment files. New records
+/// are appended to the newest segment, when the segments outgrow maxBytes the oldest one is deleted
+/// with every index entry pointing into it. Processes coordinate with flock on the index, threads
+/// of one process with a mutex. Records carry their key, so a lookup never returns another
+/// request's response even if two keys hash alike.
+class DiskCache {
+public:
+    /// @brief Segments maxBytes is split into, the unit of eviction
+    static constexpr uint64_t SegmentCount = 8;
+
+    /// @brief Open or create the cache in config.directory
+    /// @param config The configuration
+    explicit DiskCache(const DiskCacheConfig& config);
+
+    /// @brief Unmap the index and close the files
+    ~DiskCache();
+
+    DiskCache(const DiskCache&) = delete;
+    DiskCache& operator=(const DiskCache&) = delete;
+
+    /// @brief Whether the directory could be opened, a closed cache misses every lookup
+    bool isOpen() const { return index != nullptr; }
+
+    /// @brief Why opening failed, empty if open
+    const std::string& error() const { return openError; }
+
+    /// @brief Whether responses of an endpoint are stored
+    /// @param endpoint Endpoint name, e.g. "dataset-filters"
+    bool cacheable(std::string_view endpoint) const;
+
+    /// @brief Find a fresh response body
+    /// @param key Full request URL plus request body
+    /// @return The body, nullopt on a miss
+    std::optional<std::string> lookup(const std::string& key);
+
+    /// @brief Append a response body and point the index at it
+    /// @param key Full request URL plus request body
+    /// @param value Response body
+    void store(const std::string& key, const std::string& value);
+
+    /// @brief Delete every segment and empty the index, for every process
+    void clear();
+
+    /// @brief Current counters
+    DiskCacheStats stats() const;
+
+private:
+    struct IndexHeader;
+    struct IndexSlot;
+
+    /// @brief Slot of a key's hash, or the first free slot on its probe sequence; the caller holds the locks
+    IndexSlot* findSlot(uint64_t hash, bool forInsert) const;
+    /// @brief Delete the oldest segment and its entries; the caller holds the locks exclusively
+    void evictOldestSegment();
+    /// @brief Reinsert the live entries to get rid of tombstones; the caller holds the locks exclusively
+    void rehash();
+    /// @brief Path of a segment file
+    std::string segmentPath(uint64_t segment) const;
+
+    DiskCacheConfig config;
+    std::string openError;
+    int indexFd = -1;
+    size_t indexBytes = 0;
+    IndexHeader* index = nullptr;
+    IndexSlot* slots = nullptr;
+    /// @brief Threads of this process, flock only orders processes
+    mutable std::mutex mutex;
+    std::atomic<unsigned long long> hits{0};
+    std::atomic<unsigned long long> misses{0};
+};
+
+#endif //USGSM2M_DISKCACHE_HPP
@@ -0,0 +1,179 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Parallel ranged download engine fetching the files behind download-request URLs
+
+
+#ifndef USGSM2M_FETCH_HPP
+#define USGSM2M_FETCH_HPP
+
+#include "usgsm2m.hpp"
+#include "usgsm2m_journal.hpp"
+#include "usgsm2m_sink.hpp"
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// @brief One file to fetch
+struct DownloadJob {
+    /// @brief Product URL, e.g. the url of an availableDownloads entry
+    std::string url;
+    /// @brief Output file, or a directory ending in '/' to name the file after the server's
+    /// Content-Disposition or the last segment of the URL
+    std::string path;
+    /// @brief M2M downloadId, passed through to the result
+    long long downloadId = 0;
+    /// @brief Receives the bytes instead of a FileSink writing path, which then only names the result.
+    /// Downloads into a sink of their own are not journaled.
+    std::shared_ptr<DownloadSink> sink;
+};
+
+/// @brief Progress of one file, reported from the engine thread
+struct DownloadProgress {
+    /// @brief Index of the job in the list given to fetch
+    size_t job = 0;
+    /// @brief downloadId of the job
+    long long downloadId = 0;
+    /// @brief Bytes written so far
+    long long bytes = 0;
+    /// @brief File size, -1 until known or if the server does not report it
+    long long totalBytes = -1;
+};
+
+/// @brief How files are split and fetched
+struct DownloadOptions {
+    /// @brief Concurrent range requests per file, each on its own connection
+    int connectionsPerFile = 4;
+    /// @brief Concurrent transfers across every file of a fetch
+    size_t maxConnections = 16;
+    /// @brief Bytes per range request
+    long long chunkBytes = 16LL << 20;
+    /// @brief Attempts per range, a retry resumes where the failed attempt stopped
+    int maxChunkAttempts = 3;
+    /// @brief Keep a journal of the ranges on disk in <path>.journal, so a failed or interrupted
+    /// download keeps its .part file and a later fetch of the same file continues where it stopped
+    bool resume = true;
+    /// @brief fdatasync the .part file before each journal entry. Without it a resumed download is
+    /// only consistent after a process exit, not after a power loss or kernel crash.
+    bool syncJournal = false;
+    /// @brief Write files through O_DIRECT, see FileSinkOptions::direct
+    bool directIO = false;
+    /// @brief curl receive buffer per range, the most a single sink write carries
+    long receiveBufferBytes = 256 << 10;
+    /// @brief Connection setup including the TLS handshake
+    std::chrono::milliseconds connectTimeout{10000};
+    /// @brief Abort a range request when fewer than lowSpeedBytes per second arrive for lowSpeedTime
+    long lowSpeedBytes = 1024;
+    /// @brief Period a range request may stay below lowSpeedBytes
+    std::chrono::seconds lowSpeedTime{60};
+    /// @brief Called on the engine thread at most every progressInterval per file and when a file completes
+    std::function<void(const DownloadProgress&)> onProgress;
+    /// @brief Minimum time between two progress reports of a file
+    std::chrono::milliseconds progressInterval{200};
+};
+
+/// @brief Outcome of one file
+struct DownloadResult {
+    /// @brief URL the job asked for
+    std::string url;
+    /// @brief File written, empty if the name could not be resolved
+    std::string path;
+    /// @brief downloadId of the job
+    long long downloadId = 0;
+    /// @brief Bytes of the file on disk, including resumedBytes
+    long long bytes = 0;
+    /// @brief Bytes taken over from an earlier, interrupted fetch
+    long long resumedBytes = 0;
+    /// @brief Wall time from the size probe to the last byte
+    std::chrono::milliseconds elapsed{0};
+    ErrorResponse errorData;
+    bool success = false;
+};
+
+/// @brief Fetches files with several concurrent HTTP range requests each, written straight into a
+/// sink, by default a FileSink preallocating the output file. A one byte range request probes the size, range support, file name and final URL
+/// after redirects, then the file is split into chunkBytes ranges of which connectionsPerFile are in
+/// flight at once. Each range is handed to the job's sink at its offset as it arrives, so peak memory
+/// is the receive buffers of the transfers in flight, whatever the file size.
+/// Servers without range support get a single stream. Files are written to <path>.part and renamed
+/// once complete. With resume, the ranges on disk are journaled in <path>.journal; a fetch finding
+/// both files for the same size and ETag or Last-Modified only requests the missing ranges, even from
+/// a freshly issued URL. Every range is sent with If-Range and must come back with the Content-Range it
+/// asked for, so a file that changes mid-download fails instead of being stitched together.
+///
+///     DownloadEngine engine;
+///     DefaultResponse request = api.downloadRequest(...);
+///     std::vector<DownloadResult> files = engine.fetch(DownloadEngine::jobsFromResponse(request.data, "/data/"));
+class DownloadEngine {
+public:
+    /// @brief Constructor
+    /// @param options How files are split and fetched
+    explicit DownloadEngine(const DownloadOptions& options = DownloadOptions());
+
+    DownloadEngine(const DownloadEngine&) = delete;
+    DownloadEngine& operator=(const DownloadEngine&) = delete;
+
+    /// @brief Fetch files concurrently, blocking until every one has completed or failed.
+    /// Must not be called from onProgress, which runs on the thread doing the transfers.
+    /// @param jobs Files to fetch
+    /// @return One result per job, in the order of jobs
+    std::vector<DownloadResult> fetch(const std::vector<DownloadJob>& jobs);
+
+    /// @brief Fetch one file, blocking until it has completed or failed
+    /// @param job File to fetch
+    /// @return The result
+    DownloadResult fetch(const DownloadJob& job);
+
+    /// @brief Start fetching one file and return at once
+    /// @param job File to fetch
+    /// @param onDone Receives the result on the engine thread, or on the calling thread if the job
+    /// fails before a transfer starts. Must not call fetch.
+    void fetchAsync(const DownloadJob& job, std::function<void(DownloadResult&&)> onDone);
+
+    /// @brief Jobs for the downloads of a downloadRequest (availableDownloads) or downloadRetrieve
+    /// (available) response. The URLs of preparingDownloads only work once the product is staged.
+    /// @param data The data of the response
+    /// @param directory Directory the files are written to, empty for the working directory
+    /// @param includePreparing Also take the preparingDownloads entries
+    /// @return One job per distinct URL
+    static std::vector<DownloadJob> jobsFromResponse(const nlohmann::json& data, const std::string& directory,
+        bool includePreparing = false);
+
+private:
+    struct Batch;
+    struct FileTransfer;
+    struct ChunkTransfer;
+
+    /// @brief Set up the transfer of one job of a batch
+    void startFile(const std::shared_ptr<Batch>& batch, size_t job, const DownloadJob& request);
+    /// @brief Probe the size and range support of a file
+    void startProbe(const std::shared_ptr<FileTransfer>& file);
+    /// @brief Open the output and its journal and start the first ranges once the probe is done
+    void onProbed(const std::shared_ptr<FileTransfer>& file, CURLcode result);
+    /// @brief Submit ranges while the file is below connectionsPerFile
+    void startChunks(const std::shared_ptr<FileTransfer>& file);
+    /// @brief Configure and submit one attempt of a range
+    void submitChunk(const std::shared_ptr<ChunkTransfer>& chunk, std::chrono::steady_clock::time_point notBefore);
+    /// @brief Stop scheduling ranges of a file and keep the first error
+    void failFile(FileTransfer& file, const std::string& message);
+    /// @brief Journal the bytes a range has written since start
+    void journalChunk(ChunkTransfer& chunk);
+    /// @brief Book a finished range, retry or fail it
+    void onChunkDone(const std::shared_ptr<ChunkTransfer>& chunk, CURLcode result);
+    /// @brief Close the sink and report the file once nothing is in flight anymore
+    void finishIfDone(const std::shared_ptr<FileTransfer>& file);
+    /// @brief Report progress, rate limited unless final
+    void reportProgress(FileTransfer& file, bool final);
+
+    static size_t ProbeHeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata);
+    static size_t ProbeWriteCallback(char* data, size_t size, size_t nmemb, void* userdata);
+    static size_t ChunkHeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata);
+    static size_t ChunkWriteCallback(char* data, size_t size, size_t nmemb, void* userdata);
+
+    DownloadOptions options;
+    CurlHandlePool handlePool;
+    /// @brief Declared last, so its destructor aborts the transfers before the rest goes away
+    CurlMultiEngine engine;
+};
+
+#endif //USGSM2M_FETCH_HPP
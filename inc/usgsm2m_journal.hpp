@@ -0,0 +1,65 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Progress journal letting an interrupted product download resume where it stopped
+
+
+#ifndef USGSM2M_JOURNAL_HPP
+#define USGSM2M_JOURNAL_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Byte ranges of a download that are on disk, kept in a small file next to the download.
+/// The file starts with a header naming the file size and the server's validator (ETag or
+/// Last-Modified), followed by one "<begin> <end>" line per range written. Lines are only appended,
+/// so a process dying mid-write leaves at most a torn last line, which is dropped on the next open.
+/// A closed journal has no ranges and ignores record.
+class DownloadJournal {
+public:
+    DownloadJournal() = default;
+
+    /// @brief Closes the journal
+    ~DownloadJournal();
+
+    DownloadJournal(const DownloadJournal&) = delete;
+    DownloadJournal& operator=(const DownloadJournal&) = delete;
+
+    /// @brief Open the journal of a download, taking over its ranges if it belongs to the same file
+    /// @param path Journal file
+    /// @param totalBytes Size of the file
+    /// @param validator ETag or Last-Modified of the file, empty if the server sent neither
+    /// @param resume Take over existing ranges, false starts a new journal
+    /// @return Whether the journal could be opened
+    bool open(const std::string& path, long long totalBytes, const std::string& validator, bool resume);
+
+    /// @brief Whether ranges are being recorded
+    bool isOpen() const { return fd >= 0; }
+
+    /// @brief Close the journal file, keeping it on disk
+    void close();
+
+    /// @brief Record that [begin, end) is on disk. Drops the journal if the entry cannot be written.
+    void record(long long begin, long long end);
+
+    /// @brief Sorted, merged ranges on disk
+    const std::vector<std::pair<long long, long long>>& completed() const { return ranges; }
+
+    /// @brief Bytes covered by the recorded ranges
+    long long completedBytes() const;
+
+    /// @brief First byte at or after offset not covered by a recorded range
+    long long nextMissing(long long offset) const;
+
+    /// @brief Start of the first recorded range after offset, or the largest offset if there is none
+    long long nextCompleted(long long offset) const;
+
+private:
+    /// @brief Add a range to the in-memory list, merging neighbours
+    void merge(long long begin, long long end);
+
+    int fd = -1;
+    std::vector<std::pair<long long, long long>> ranges;
+};
+
+#endif //USGSM2M_JOURNAL_HPP
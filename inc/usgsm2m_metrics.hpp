@@ -0,0 +1,152 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Lock-free per-endpoint request metrics of the USGS M2M API client
+
+
+#ifndef USGSM2M_METRICS_HPP
+#define USGSM2M_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// @brief Log-linear latency histogram in microseconds, HDR style: every power of two is split
+/// into SubBuckets linear buckets, so any recorded value is off by at most 1/SubBuckets.
+/// Recording is a single relaxed atomic increment.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SubBucketBits = 3;
+    static constexpr uint64_t SubBuckets = 1u << SubBucketBits;
+    /// @brief Values at or above 2^MaxBits microseconds (about 12.7 days) land in the last bucket
+    static constexpr unsigned MaxBits = 40;
+    static constexpr size_t BucketCount = (MaxBits - SubBucketBits + 1) * SubBuckets;
+
+    /// @brief Count one value
+    void record(uint64_t micros);
+
+    /// @brief Bucket holding a value
+    static size_t bucketIndex(uint64_t micros);
+
+    /// @brief Smallest value of a bucket
+    static uint64_t bucketLowerBound(size_t index);
+
+    /// @brief Count of one bucket
+    uint64_t bucketCount(size_t index) const { return buckets[index].load(std::memory_order_relaxed); }
+
+    /// @brief Sum of every recorded value
+    uint64_t sum() const { return total.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> buckets{};
+    std::atomic<uint64_t> total{0};
+};
+
+/// @brief Point-in-time copy of a LatencyHistogram
+struct LatencyHistogramSnapshot {
+    /// @brief Non-empty buckets as {exclusive upper bound in microseconds, count}, ascending
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;
+    uint64_t count = 0;
+    uint64_t sumMicros = 0;
+
+    /// @brief Latency below which the given fraction of requests completed
+    /// @param fraction Between 0 and 1, e.g. 0.99
+    /// @return Upper bound of the bucket holding that rank, zero if nothing was recorded
+    std::chrono::microseconds percentile(double fraction) const;
+
+    /// @brief Number of values below a bound, exact when the bound is a power of two
+    uint64_t countBelow(uint64_t micros) const;
+};
+
+/// @brief Point-in-time metrics of one endpoint
+struct EndpointMetricsSnapshot {
+    /// @brief Endpoint name, e.g. "scene-search"
+    std::string endpoint;
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+    /// @brief Failed requests per ErrorResponse::errorCode
+    std::map<int, uint64_t> errorCodes;
+    /// @brief Encode, transfer and decode time of every request
+    LatencyHistogramSnapshot latency;
+};
+
+/// @brief Point-in-time metrics of every endpoint used so far
+struct MetricsSnapshot {
+    std::vector<EndpointMetricsSnapshot> endpoints;
+
+    /// @brief Render in the Prometheus text exposition format
+    /// @param prefix Metric name prefix
+    /// @return usgsm2m_requests_total, usgsm2m_request_failures_total, usgsm2m_errors_total,
+    /// usgsm2m_bytes_sent_total, usgsm2m_bytes_received_total and the
+    /// usgsm2m_request_duration_seconds histogram, labelled by endpoint
+    std::string prometheusText(const std::string& prefix = "usgsm2m") const;
+};
+
+/// @brief Request metrics keyed by endpoint. Recording never locks: endpoints are claimed in a fixed
+/// open-addressing table with compare-and-swap and every counter is a relaxed atomic.
+class MetricsRegistry {
+public:
+    /// @brief Maximum distinct endpoints tracked, the M2M API has fewer than 100
+    static constexpr size_t MaxEndpoints = 256;
+    /// @brief Distinct error codes tracked per endpoint, further codes are counted under -1
+    static constexpr size_t MaxErrorCodes = 16;
+
+    MetricsRegistry() = default;
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /// @brief Count one completed request
+    /// @param endpoint Endpoint name, e.g. "scene-search"
+    /// @param latency Time the request took
+    /// @param bytesSent Request body bytes
+    /// @param bytesReceived Response body bytes
+    /// @param success Whether the request succeeded
+    /// @param errorCode Error code of a failed request
+    void record(const std::string& endpoint, std::chrono::microseconds latency, uint64_t bytesSent,
+        uint64_t bytesReceived, bool success, const std::optional<int>& errorCode);
+
+    /// @brief Copy the current metrics, endpoints sorted by name
+    MetricsSnapshot snapshot() const;
+
+private:
+    struct ErrorSlot {
+        std::atomic<int64_t> code{EmptyCode};
+        std::atomic<uint64_t> count{0};
+    };
+
+    struct Endpoint {
+        explicit Endpoint(std::string name) : name(std::move(name)) {
+            // Reserved for overflow, so codes beyond MaxErrorCodes are never dropped
+            errors[0].code = -1;
+        }
+
+        const std::string name;
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> failures{0};
+        std::atomic<uint64_t> bytesSent{0};
+        std::atomic<uint64_t> bytesReceived{0};
+        std::array<ErrorSlot, MaxErrorCodes> errors{};
+        LatencyHistogram latency;
+    };
+
+    static constexpr int64_t EmptyCode = INT64_MIN;
+
+    /// @brief Find or claim the slot of an endpoint
+    /// @return nullptr if the table is full
+    Endpoint* find(const std::string& endpoint);
+
+    static void countError(Endpoint& metrics, int code);
+
+    std::array<std::atomic<Endpoint*>, MaxEndpoints> slots{};
+};
+
+#endif //USGSM2M_METRICS_HPP
@@ -0,0 +1,199 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Download pipeline taking entity IDs from download-request to files on disk
+
+
+#ifndef USGSM2M_PIPELINE_HPP
+#define USGSM2M_PIPELINE_HPP
+
+#include "usgsm2m_fetch.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+/// @brief Counts of the downloads of a run per stage, passed to the progress callback
+struct DownloadPipelineProgress {
+    /// @brief Entities whose download-request has not returned yet
+    size_t requested = 0;
+    /// @brief Downloads per DownloadStage
+    size_t preparing = 0;
+    size_t available = 0;
+    size_t fetching = 0;
+    size_t completed = 0;
+    size_t failed = 0;
+    /// @brief download-retrieve calls so far
+    size_t polls = 0;
+    /// @brief Current poll interval
+    std::chrono::milliseconds pollInterval{0};
+};
+
+/// @brief How the pipeline requests, polls and fetches
+struct DownloadPipelineOptions {
+    /// @brief Directory the files are written to, empty for the working directory
+    std::string directory;
+    /// @brief Label of the download requests, which download-retrieve is filtered by. Empty for a label
+    /// unique to the run; pass the label of an interrupted run to adopt its downloads.
+    std::string label;
+    /// @brief Passed to download-request and download-retrieve
+    std::optional<std::string> downloadApplication;
+    /// @brief Entities per download-request call
+    size_t requestBatchSize = 100;
+    /// @brief download-request calls in flight at once
+    size_t maxConcurrentRequests = 2;
+    /// @brief Files transferred at once, each with up to download.connectionsPerFile connections
+    size_t maxConcurrentFiles = 8;
+    /// @brief Poll interval right after a download became available or started preparing, at least 1 s
+    std::chrono::milliseconds minPollInterval{5000};
+    /// @brief Longest poll interval while nothing changes
+    std::chrono::milliseconds maxPollInterval{120000};
+    /// @brief Growth of the poll interval per poll that made no progress
+    double pollBackoff = 1.5;
+    /// @brief Give up on a download still preparing after this long
+    std::chrono::minutes prepareTimeout{240};
+    /// @brief Report finished files with download-complete-proxied, for proxied download applications
+    bool completeProxied = false;
+    /// @brief How each file is fetched
+    DownloadOptions download;
+    /// @brief Called on the thread inside run whenever a download changes stage, exceptions are ignored
+    std::function<void(const DownloadPipelineProgress&)> onProgress;
+};
+
+/// @brief Where a download of the pipeline is
+enum class DownloadStage {
+    /// @brief Sent with download-request, no download ID yet
+    Requested,
+    /// @brief Being staged by USGS, polled with download-retrieve
+    Preparing,
+    /// @brief Has a URL, waiting for a transfer slot
+    Available,
+    /// @brief Being transferred
+    Fetching,
+    /// @brief File on disk
+    Completed,
+    /// @brief Given up
+    Failed
+};
+
+/// @brief Outcome of one download of a run
+struct DownloadPipelineResult {
+    /// @brief Entity the download belongs to, empty if the server did not say
+    std::string entityId;
+    /// @brief M2M downloadId, 0 if download-request did not return one
+    long long downloadId = 0;
+    DownloadStage stage = DownloadStage::Requested;
+    /// @brief The transfer, if one was attempted
+    DownloadResult file;
+    /// @brief Whether download-complete-proxied accepted the file
+    bool completeReported = false;
+    ErrorResponse errorData;
+    bool success = false;
+};
+
+/// @brief Runs download-request, download-retrieve polling, the transfer and download-complete-proxied
+/// for any number of entities. Requests go out in batches on the client's asynchronous event loop,
+/// available files go to a DownloadEngine as soon as they have a URL, and every preparing download is
+/// polled with a single download-retrieve call for the run's label. The poll interval starts at
+/// minPollInterval, grows by pollBackoff on every poll that finds nothing new and drops back once a
+/// download becomes available. Downloads the server reports for an entity of the run, e.g. duplicates
+/// of an earlier request under the same label, are adopted by the poll.
+///
+///     DownloadPipelineOptions options;
+///     options.directory = "/data/landsat/";
+///     DownloadPipeline pipeline(api, options);
+///     std::vector<DownloadPipelineResult> results = pipeline.run(downloads);
+class DownloadPipeline {
+public:
+    /// @brief Constructor
+    /// @param api Logged in client, must outlive the pipeline
+    /// @param options How the pipeline requests, polls and fetches
+    explicit DownloadPipeline(USGS_M2M_API& api, const DownloadPipelineOptions& options = DownloadPipelineOptions());
+
+    DownloadPipeline(const DownloadPipeline&) = delete;
+    DownloadPipeline& operator=(const DownloadPipeline&) = delete;
+
+    /// @brief Request, wait for and fetch every download, blocking until each one has completed or failed.
+    /// One run at a time.
+    /// @param downloads Entities to download, with their product IDs
+    /// @return One result per download ID, plus a failed one per entity that got none. If the server returned
+    /// downloads without entity IDs, such an entity may have been served by one of them, its error says so
+    std::vector<DownloadPipelineResult> run(const std::vector<Download>& downloads);
+
+    /// @brief Label of the requests of the last run
+    const std::string& label() const { return runLabel; }
+
+private:
+    struct Item {
+        DownloadPipelineResult result;
+        std::string url;
+        std::chrono::steady_clock::time_point preparingSince;
+    };
+
+    /// @brief A finished download-request batch or transfer, handed from the event loops to run
+    struct Event {
+        size_t batch = 0;
+        DefaultResponse response;
+        size_t item = 0;
+        DownloadResult file;
+        bool isFetch = false;
+    };
+
+    /// @brief Send the next download-request batch
+    void submitBatch(const std::vector<Download>& downloads, size_t batch);
+    /// @brief Track the downloads of a download-request response
+    void onBatchDone(const std::vector<Download>& downloads, size_t batch, DefaultResponse& response);
+    /// @brief Track or update a download of a download-request or download-retrieve entry
+    /// @return Whether the download became available
+    bool trackEntry(const nlohmann::json& entry, bool available, bool adoptOnly);
+    /// @brief Hand available downloads to the engine while below maxConcurrentFiles
+    void startFetches();
+    /// @brief Ask download-retrieve about the preparing downloads and adapt the interval
+    void poll();
+    /// @brief Report finished files with download-complete-proxied
+    void reportProxied();
+    /// @brief Move an item to another stage
+    void setStage(Item& item, DownloadStage stage);
+    /// @brief Fail an item
+    void failItem(Item& item, const std::string& message);
+    /// @brief Call onProgress if a stage changed since the last call
+    void reportProgress();
+    /// @brief Wait for every outstanding download-request and transfer callback and drop what they report
+    void drain();
+
+    USGS_M2M_API& api;
+    DownloadPipelineOptions options;
+    std::string runLabel;
+
+    std::vector<Item> items;
+    std::map<long long, size_t> byDownloadId;
+    /// @brief Entities of the run without a download ID
+    std::set<std::string> unmatched;
+    /// @brief Whether a returned download did not name its entity, so unmatched entities are only unconfirmed
+    bool anonymousEntries = false;
+    std::deque<size_t> availableQueue;
+    DownloadPipelineProgress progress;
+    bool progressChanged = false;
+    /// @brief Submitted download-request batches whose callback has not been taken from events yet
+    size_t requestsInFlight = 0;
+    /// @brief Started transfers whose callback has not been taken from events yet
+    size_t fetchesInFlight = 0;
+    std::chrono::milliseconds pollInterval{0};
+    std::chrono::steady_clock::time_point nextPoll;
+    /// @brief Whether download-retrieve was asked since the last download-request returned
+    bool polledSinceRequests = true;
+    std::vector<size_t> proxiedPending;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Event> events;
+    /// @brief Declared last, so its destructor aborts the transfers before the state they report into goes away
+    DownloadEngine engine;
+};
+
+#endif //USGSM2M_PIPELINE_HPP
@@ -0,0 +1,122 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Client-side token bucket pacing the requests of the USGS M2M API client
+
+
+#ifndef USGSM2M_RATELIMIT_HPP
+#define USGSM2M_RATELIMIT_HPP
+
+#include <chrono>
+#include <mutex>
+
+/// @brief Point-in-time state of a RateLimiter
+struct RateLimitState {
+    /// @brief Whether requests are paced at all
+    bool enabled = false;
+    /// @brief Tokens added per second right now
+    double rate = 0;
+    /// @brief Rate the limiter climbs back to after backing off
+    double ceiling = 0;
+    /// @brief Tokens that can be spent at once
+    double burst = 0;
+    /// @brief Tokens available, negative while reservations are queued
+    double tokens = 0;
+    /// @brief Limit errors reported so far
+    unsigned long long limitErrors = 0;
+};
+
+/// @brief Token bucket with reservations and AIMD adaptation.
+/// reserve() never blocks: it takes the tokens, possibly going into debt, and returns when the request
+/// may be sent, so blocking callers sleep until then and asynchronous ones delay the transfer.
+/// Every limit error halves the rate and pauses sending, every success adds back a fraction of the
+/// ceiling. A limit error also caps the ceiling just below the rate requests were actually accepted
+/// at, so the rate settles right under the server's real limit. While running at the ceiling without
+/// errors the ceiling creeps up again, so a one-off error or a raised limit is not held against the client.
+/// A limit error writes off the reservations made before it; their requests reserve again at the new rate.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Fraction of the ceiling added back per successful request
+    static constexpr double IncreaseFraction = 0.05;
+    /// @brief Factor applied to the rate on a limit error
+    static constexpr double DecreaseFactor = 0.5;
+    /// @brief Ceiling after a limit error, as a fraction of the rate requests were accepted at
+    static constexpr double CeilingBackoff = 0.9;
+    /// @brief Time constant of the accepted request rate estimate, in seconds
+    static constexpr double AcceptedRateWindow = 1.0;
+    /// @brief Growth of the ceiling per second spent at it without a limit error
+    static constexpr double ProbeFraction = 0.01;
+    /// @brief The rate never drops below this many tokens per second
+    static constexpr double MinRate = 0.05;
+    /// @brief Lowest ceiling a limit error sets when no rate was configured. A client refused on its first
+    /// requests, e.g. because another client used up the shared quota, has no accepted rate to go by.
+    static constexpr double ColdStartRate = 1.0;
+
+    /// @brief Tokens taken by reserve
+    struct Reservation {
+        /// @brief Earliest time the request may be sent
+        Clock::time_point at{};
+        double tokens = 0;
+        /// @brief Limit errors the limiter had backed off for when the tokens were taken
+        unsigned long long generation = 0;
+    };
+
+    /// @brief Set the rate and start pacing
+    /// @param ratePerSecond Tokens added per second, 0 or less stops pacing
+    /// @param burst Tokens that can be spent at once, at least 1
+    /// @param available Tokens available right away, a full bucket by default
+    void configure(double ratePerSecond, double burst, double available = -1);
+
+    /// @brief Take tokens and get the earliest time the request may be sent
+    /// @param tokens Tokens the request costs
+    /// @return The reservation, due now when tokens were available, later when the request has to wait
+    Reservation reserve(double tokens = 1);
+
+    /// @brief Give back the tokens of a reservation that will not be used, nothing for a stale one
+    /// @param reservation Reservation returned by reserve
+    void cancel(const Reservation& reservation);
+
+    /// @brief Whether a limit error since the reservation wrote it off, so it has to be made again
+    /// @param reservation Reservation returned by reserve
+    bool stale(const Reservation& reservation) const;
+
+    /// @brief Report a request that went through without a limit error
+    void onSuccess();
+
+    /// @brief Report a limit error from the server
+    /// @param retryAfter Delay the server asked for, zero if it did not say
+    void onLimited(std::chrono::seconds retryAfter = std::chrono::seconds{0});
+
+    /// @brief Copy the current state
+    RateLimitState state() const;
+
+private:
+    /// @brief Add the tokens earned since the last refill, capped at burst
+    void refill(Clock::time_point now);
+
+    /// @brief Accepted requests per second, decayed up to now
+    double acceptedRateAt(Clock::time_point now) const;
+
+    mutable std::mutex mutex;
+    bool enabled = false;
+    double rate = 0;
+    double ceiling = 0;
+    /// @brief Rate given to configure, the ceiling never probes above it; 0 when the rate was learned
+    double configuredRate = 0;
+    double burst = 1;
+    double tokens = 0;
+    Clock::time_point lastRefill{};
+    /// @brief Nothing is sent before this point after a limit error
+    Clock::time_point pausedUntil{};
+    unsigned long long limitErrors = 0;
+    /// @brief Limit errors the limiter backed off for, each one writes off the reservations before it
+    unsigned long long backoffs = 0;
+    /// @brief Since when the rate has been at the ceiling without an error
+    Clock::time_point atCeilingSince{};
+    /// @brief Exponentially decayed count of successful requests, an estimate of the accepted rate
+    double acceptedRate = 0;
+    Clock::time_point lastAccepted{};
+};
+
+#endif //USGSM2M_RATELIMIT_HPP
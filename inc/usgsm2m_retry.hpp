@@ -0,0 +1,72 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Retry policy and retry budget of the USGS M2M API client
+
+
+#ifndef USGSM2M_RETRY_HPP
+#define USGSM2M_RETRY_HPP
+
+#include <curl/curl.h>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+
+/// @brief When and how failed requests are sent again.
+/// Transient failures are retried: connection failures, timeouts, HTTP 429, 500, 502, 503 and 504,
+/// and RATE_LIMIT errors. Endpoints in nonIdempotentEndpoints are only retried when the server
+/// cannot have acted on the request: the connection was never made or it answered 429 / RATE_LIMIT.
+struct RetryPolicy {
+    /// @brief Attempts per request including the first one, 1 disables retries
+    int maxAttempts = 1;
+    /// @brief Delay before the first retry
+    std::chrono::milliseconds initialBackoff{250};
+    /// @brief Longest delay between two attempts
+    std::chrono::milliseconds maxBackoff{20000};
+    /// @brief Growth of the delay per attempt
+    double backoffMultiplier = 2.0;
+    /// @brief Fraction of each delay that is random, 1 for full jitter and 0 for none
+    double jitter = 1.0;
+    /// @brief Retries earned per request, e.g. 0.1 lets retries add at most 10% to the request load
+    double budgetRatio = 0.1;
+    /// @brief Retries that can be spent at once, also the starting balance
+    double budgetMax = 10;
+    /// @brief Endpoints a duplicate request would act on twice
+    std::set<std::string> nonIdempotentEndpoints{
+        "download-complete-proxied", "download-order-load", "download-request", "order-submit"};
+
+    /// @brief Whether a failed attempt may be sent again
+    /// @param endpoint Endpoint name, e.g. "scene-search"
+    /// @param result Transfer result reported by curl
+    /// @param httpCode The HTTP response code, 0 if there was no response
+    /// @param errorCodeName M2M error code name of the response, empty if none
+    /// @return true if the failure is transient and retrying is safe for the endpoint
+    bool retryable(const std::string& endpoint, CURLcode result, long httpCode, const std::string& errorCodeName) const;
+
+    /// @brief Delay before the next attempt
+    /// @param attempt Attempts made so far, at least 1
+    /// @param retryAfter Delay asked for by the server, the result is never shorter
+    /// @return Exponential backoff capped at maxBackoff, with jitter applied
+    std::chrono::milliseconds backoff(int attempt, std::chrono::seconds retryAfter = std::chrono::seconds{0}) const;
+};
+
+/// @brief Caps retries at a fraction of the requests sent, so an outage does not multiply the load.
+/// Every first attempt deposits budgetRatio, every retry withdraws one.
+class RetryBudget {
+public:
+    /// @brief Count a first attempt
+    /// @param policy Policy providing the ratio and the cap
+    void deposit(const RetryPolicy& policy);
+
+    /// @brief Take one retry from the budget
+    /// @param policy Policy providing the cap
+    /// @return false if the budget is exhausted
+    bool withdraw(const RetryPolicy& policy);
+
+private:
+    std::mutex mutex;
+    /// @brief Negative until first used, then starts at budgetMax
+    double tokens = -1;
+};
+
+#endif //USGSM2M_RETRY_HPP
@@ -0,0 +1,123 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Destinations the download engine writes product bytes to
+
+
+#ifndef USGSM2M_SINK_HPP
+#define USGSM2M_SINK_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/// @brief Receives the bytes of one downloaded file as they come off the connection.
+/// Every call for a file is made from the download engine's thread, one at a time. The ranges of a
+/// ranged download arrive concurrently, so writes come out of order; each write continues its own
+/// range where that range's previous write stopped. A failed call fails the file with error.
+class DownloadSink {
+public:
+    virtual ~DownloadSink() = default;
+
+    /// @brief Called once the size is known, before the first write
+    /// @param totalBytes File size, -1 for a stream of unknown size
+    /// @param error Why the sink cannot take the file
+    /// @return Whether writes can follow
+    virtual bool open(long long totalBytes, std::string& error) = 0;
+
+    /// @brief Take bytes of the file
+    /// @param offset Position of data in the file
+    /// @param data Bytes, only valid during the call
+    /// @param size Number of bytes
+    /// @param error Why the bytes could not be taken
+    /// @return Whether the bytes were taken
+    virtual bool write(long long offset, const char* data, size_t size, std::string& error) = 0;
+
+    /// @brief Make every byte written so far durable, called before it is journaled
+    /// @param error Why the bytes could not be made durable
+    /// @return Whether the bytes are durable
+    virtual bool sync(std::string& error) { (void)error; return true; }
+
+    /// @brief Called once after the last write, also when the file failed
+    /// @param success Whether every byte of the file was written
+    /// @param error Why a complete file could not be finished
+    /// @return Whether the file was finished
+    virtual bool close(bool success, std::string& error) = 0;
+};
+
+/// @brief How a FileSink treats its files
+struct FileSinkOptions {
+    /// @brief Write into an existing .part file instead of truncating it
+    bool keepExisting = false;
+    /// @brief Keep the .part file when the download fails, so it can be resumed
+    bool keepOnFailure = false;
+    /// @brief Write through O_DIRECT, bypassing the page cache. Block aligned parts of each write go
+    /// through a fixed aligned bounce buffer, the unaligned edges through the page cache. Falls back to
+    /// buffered writes where the filesystem refuses O_DIRECT, e.g. tmpfs.
+    bool direct = false;
+};
+
+/// @brief Writes a file into <path>.part with pwrite at the offset of each write and renames it to
+/// path once complete. The file is fallocated to its full size up front, so ranges landing out of
+/// order neither fragment it nor run out of space halfway. Memory use does not depend on the file size.
+class FileSink : public DownloadSink {
+public:
+    /// @brief Alignment of O_DIRECT offsets, sizes and buffers
+    static constexpr size_t DirectAlignment = 4096;
+    /// @brief Size of the bounce buffer of O_DIRECT writes
+    static constexpr size_t DirectBufferBytes = 1 << 20;
+
+    /// @brief Constructor
+    /// @param path File to create
+    /// @param options How the file is written
+    explicit FileSink(std::string path, const FileSinkOptions& options = FileSinkOptions());
+
+    /// @brief Closes a file that was not closed, keeping the .part file
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    bool open(long long totalBytes, std::string& error) override;
+    bool write(long long offset, const char* data, size_t size, std::string& error) override;
+    bool sync(std::string& error) override;
+    bool close(bool success, std::string& error) override;
+
+    /// @brief Whether writes currently bypass the page cache
+    bool directActive() const { return directFd >= 0; }
+
+private:
+    /// @brief pwrite all of data on fd, retrying short writes
+    static bool writeAt(int fd, const char* data, size_t size, long long offset);
+    /// @brief Close the O_DIRECT descriptor, the remaining writes go through the page cache
+    void dropDirect();
+
+    std::string path;
+    std::string partPath;
+    FileSinkOptions options;
+    int fd = -1;
+    int directFd = -1;
+    char* bounce = nullptr;
+};
+
+/// @brief Hands every write to a function, e.g. to feed an extractor or an upload without touching disk
+class CallbackSink : public DownloadSink {
+public:
+    /// @brief Called with each block of bytes, returns false to fail the file
+    using Writer = std::function<bool(long long offset, const char* data, size_t size)>;
+
+    /// @brief Constructor
+    /// @param writer Called for every write
+    /// @param onClose Optional, called once with whether the file completed
+    explicit CallbackSink(Writer writer, std::function<void(bool success)> onClose = nullptr)
+        : writer(std::move(writer)), onClose(std::move(onClose)) {}
+
+    bool open(long long, std::string&) override { return true; }
+    bool write(long long offset, const char* data, size_t size, std::string& error) override;
+    bool close(bool success, std::string& error) override;
+
+private:
+    Writer writer;
+    std::function<void(bool success)> onClose;
+};
+
+#endif //USGSM2M_SINK_HPP
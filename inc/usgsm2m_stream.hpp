@@ -0,0 +1,87 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Incremental JSON record splitter used by the streaming USGS M2M API calls
+
+
+#ifndef USGSM2M_STREAM_HPP
+#define USGSM2M_STREAM_HPP
+
+#include <nlohmann/json.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// @brief Push parser that pulls the elements of one array out of a JSON document as bytes arrive.
+/// Each element is parsed on its own and handed to a callback, everything outside the array
+/// is kept as a small envelope document in which the array is empty. Neither the full body
+/// nor a DOM of it is ever held.
+class JsonRecordStream {
+public:
+    /// @brief Receives one array element, return false to stop the transfer
+    using RecordHandler = std::function<bool(nlohmann::json&& record)>;
+
+    /// @brief Constructor
+    /// @param arrayPaths Object keys leading to the array to split, e.g. {{"data", "results"}}.
+    /// "*" matches any key. Every array matching one of the paths is split.
+    /// @param onRecord Callback receiving each element
+    JsonRecordStream(std::vector<std::vector<std::string>> arrayPaths, RecordHandler onRecord);
+
+    /// @brief Feed the next chunk of the document
+    /// @param data Chunk start
+    /// @param size Chunk length
+    /// @return false if a record could not be parsed or the handler asked to stop
+    bool feed(const char* data, size_t size);
+
+    /// @brief Whether the handler asked to stop, which is not a failure
+    bool stopped() const { return stopRequested; }
+
+    /// @brief The document with the split array emptied
+    const std::string& envelope() const { return envelopeText; }
+
+    /// @brief Number of records handed to the callback
+    size_t recordCount() const { return records; }
+
+    /// @brief Whether feeding stopped early
+    bool failed() const { return !errorText.empty(); }
+
+    /// @brief Why feeding stopped early
+    const std::string& errorMessage() const { return errorText; }
+
+    /// @brief curl write callback, userp must point to a JsonRecordStream
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
+
+private:
+    struct Frame {
+        bool isArray = false;
+        /// @brief Objects only: the next string is a key
+        bool expectKey = true;
+        /// @brief Objects only: the most recent key
+        std::string key;
+    };
+
+    /// @brief Whether an array opened now sits at one of the requested paths
+    bool atArrayPath() const;
+
+    /// @brief Parse and hand over the element collected so far
+    bool emitRecord();
+
+    std::vector<std::vector<std::string>> arrayPaths;
+    RecordHandler onRecord;
+
+    std::vector<Frame> stack;
+    std::string envelopeText;
+    std::string keyText;
+    std::string recordText;
+    std::string errorText;
+    bool inString = false;
+    bool escape = false;
+    bool stringIsKey = false;
+    /// @brief Inside a split array, copying elements into recordText
+    bool splitting = false;
+    /// @brief Nesting depth inside the current element
+    int recordDepth = 0;
+    size_t records = 0;
+    bool stopRequested = false;
+};
+
+#endif //USGSM2M_STREAM_HPP
@@ -0,0 +1,18 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Timestamp parsing shared by the JSON and arena decoders, internal to the library
+
+
+#ifndef USGSM2M_TIME_HPP
+#define USGSM2M_TIME_HPP
+
+#include <ctime>
+#include <string>
+
+/// @brief Parse an M2M timestamp "YYYY-MM-DD hh:mm:ss" (or with a 'T' separator), with optional
+/// fractional seconds and a "Z" or "±hh[:mm]" offset. Times without an offset are taken as UTC.
+/// @param text Timestamp as sent by the server
+/// @return Seconds since the epoch (UTC), -1 if text is not a date
+time_t parseM2MTime(const std::string& text);
+
+#endif //USGSM2M_TIME_HPP
@@ -0,0 +1,58 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Request timeouts and per-call deadlines of the USGS M2M API client
+
+
+#ifndef USGSM2M_TIMEOUT_HPP
+#define USGSM2M_TIMEOUT_HPP
+
+#include <chrono>
+#include <optional>
+
+/// @brief Time limits of a single request attempt
+struct TimeoutConfig {
+    /// @brief Connection setup including the TLS handshake, 0 for curl's default
+    std::chrono::milliseconds connect{10000};
+    /// @brief Whole attempt from connecting to the last response byte, 0 for no limit
+    std::chrono::milliseconds total{10000};
+    /// @brief Abort when fewer than lowSpeedBytes per second arrive for lowSpeedTime, 0 disables
+    long lowSpeedBytes = 0;
+    /// @brief Period the transfer may stay below lowSpeedBytes
+    std::chrono::seconds lowSpeedTime{0};
+};
+
+/// @brief Bounds every request issued by the current thread while in scope, including rate limiter
+/// waits, retries, and pages or asynchronous requests submitted from it. Each attempt only gets the
+/// time that is left, and requests that cannot start before the deadline fail with "Deadline exceeded."
+/// Nested deadlines can only shorten the enclosing one.
+///
+///     RequestDeadline deadline(std::chrono::seconds(2));
+///     DefaultResponse result = api.placename(std::string("US"), std::string("Sioux Falls"));
+class RequestDeadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Deadline a duration from now
+    /// @param budget Time the calls in scope may take
+    explicit RequestDeadline(std::chrono::milliseconds budget);
+
+    /// @brief Deadline at a point in time
+    /// @param deadline Point after which no request is sent
+    explicit RequestDeadline(Clock::time_point deadline);
+
+    /// @brief Restores the enclosing deadline
+    ~RequestDeadline();
+
+    RequestDeadline(const RequestDeadline&) = delete;
+    RequestDeadline& operator=(const RequestDeadline&) = delete;
+
+    /// @brief Deadline in effect on this thread
+    /// @return nullopt if no RequestDeadline is in scope
+    static std::optional<Clock::time_point> current();
+
+private:
+    std::optional<Clock::time_point> previous;
+    static thread_local std::optional<Clock::time_point> active;
+};
+
+#endif //USGSM2M_TIMEOUT_HPP
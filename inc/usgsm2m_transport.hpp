@@ -0,0 +1,170 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Shared curl transport pieces used by the USGS M2M API client
+
+
+#ifndef USGSM2M_TRANSPORT_HPP
+#define USGSM2M_TRANSPORT_HPP
+
+#include <curl/curl.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief Immutable set of request headers, shared by every request sent while it is current
+struct HeaderSet {
+    /// @brief Header lines, e.g. "Accept: application/json"
+    std::vector<std::string> lines;
+    /// @brief curl list built from lines
+    struct curl_slist* list = nullptr;
+    /// @brief lines plus "Content-Encoding: gzip", sent with compressed request bodies
+    struct curl_slist* compressedBodyList = nullptr;
+
+    HeaderSet() = default;
+    explicit HeaderSet(std::vector<std::string> headerLines);
+    ~HeaderSet();
+
+    HeaderSet(const HeaderSet&) = delete;
+    HeaderSet& operator=(const HeaderSet&) = delete;
+};
+
+/// @brief Process-wide curl share handle holding the DNS cache and TLS sessions.
+/// Every client and every pooled handle in the process attaches to it, so only the first
+/// request to m2m.cr.usgs.gov pays for the lookup and the full handshake. Connections are not
+/// shared, each pooled handle and the multi handle reuse their own.
+class CurlShareCache {
+public:
+    /// @brief Get the process-wide cache, initializing libcurl on first use
+    /// @return The shared cache
+    static CurlShareCache& instance();
+
+    /// @brief Make sure curl_global_init has run exactly once in this process
+    static void ensureGlobalInit();
+
+    /// @brief The share handle, nullptr if it could not be created
+    CURLSH* get() const { return share; }
+
+    /// @brief Attach an easy handle to the shared cache
+    /// @param handle Handle to attach
+    void attach(CURL* handle) const;
+
+    CurlShareCache(const CurlShareCache&) = delete;
+    CurlShareCache& operator=(const CurlShareCache&) = delete;
+
+private:
+    CurlShareCache();
+
+    static void lockData(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlockData(CURL* handle, curl_lock_data data, void* userptr);
+
+    CURLSH* share = nullptr;
+    /// @brief One lock per kind of shared data, curl asks for them independently
+    std::mutex locks[CURL_LOCK_DATA_LAST];
+};
+
+/// @brief Thread-safe pool of reusable curl easy handles.
+/// Reusing a handle keeps its connection, DNS and TLS session caches warm.
+class CurlHandlePool {
+public:
+    /// @brief An easy handle checked out of the pool, returned on destruction
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(CurlHandlePool* pool, CURL* handle) : pool(pool), handle(handle) {}
+        ~Lease() { reset(); }
+
+        Lease(Lease&& other) noexcept : pool(other.pool), handle(other.handle) { other.handle = nullptr; }
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        /// @brief The leased handle, nullptr if none could be created
+        CURL* get() const { return handle; }
+        explicit operator bool() const { return handle != nullptr; }
+
+        /// @brief Give the handle back to the pool early
+        void reset();
+
+    private:
+        CurlHandlePool* pool = nullptr;
+        CURL* handle = nullptr;
+    };
+
+    /// @brief Constructor
+    /// @param maxIdle Number of idle handles kept for reuse
+    /// @param shareCache Cache every handle is attached to, nullptr for none
+    explicit CurlHandlePool(size_t maxIdle = 8, const CurlShareCache* shareCache = nullptr);
+
+    /// @brief Destructor, cleans up every idle handle
+    ~CurlHandlePool();
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+    /// @brief Check out an idle handle or create a new one
+    /// @return Lease owning the handle until it is destroyed
+    Lease acquire();
+
+    /// @brief Return a handle, resetting its options but keeping its caches
+    /// @param handle Handle previously obtained through acquire()
+    void release(CURL* handle);
+
+    /// @brief Change the number of idle handles kept for reuse
+    /// @param maxIdle New limit
+    void setMaxIdle(size_t maxIdle);
+
+private:
+    std::mutex mutex;
+    std::vector<CURL*> idle;
+    size_t maxIdle;
+    const CurlShareCache* shareCache;
+};
+
+/// @brief Thread-safe pool of response body buffers, recycled across requests so that their
+/// capacity is reused. A buffer handed out is pre-sized to the size earlier responses of the same
+/// endpoint had, so a response is received without growing the buffer step by step.
+class ResponseBufferPool {
+public:
+    /// @brief Largest capacity reserved up front, from an estimate or a Content-Length
+    static constexpr size_t MaxPresize = 64 << 20;
+    /// @brief Weight of the latest response in the size estimate of its endpoint
+    static constexpr double SizeWeight = 0.2;
+    /// @brief Capacity reserved on top of the estimate, so most responses fit without growing
+    static constexpr double Headroom = 1.25;
+
+    /// @brief Constructor
+    /// @param maxIdle Number of idle buffers kept for reuse
+    /// @param maxRetainedBytes Buffers with a larger capacity are freed instead of kept
+    explicit ResponseBufferPool(size_t maxIdle = 8, size_t maxRetainedBytes = 1 << 20);
+
+    ResponseBufferPool(const ResponseBufferPool&) = delete;
+    ResponseBufferPool& operator=(const ResponseBufferPool&) = delete;
+
+    /// @brief Check out an empty buffer with room for a typical response of an endpoint
+    /// @param endpoint Endpoint name, e.g. "scene-metadata"
+    /// @return The buffer, owned by the caller until given back with release
+    std::string acquire(std::string_view endpoint);
+
+    /// @brief Give a buffer back and learn the response size of its endpoint
+    /// @param endpoint Endpoint name the buffer was acquired for
+    /// @param buffer The buffer holding the response body
+    void release(std::string_view endpoint, std::string buffer);
+
+    /// @brief Change how many buffers are kept and how large they may be
+    /// @param maxIdle Number of idle buffers kept for reuse
+    /// @param maxRetainedBytes Buffers with a larger capacity are freed instead of kept
+    void setLimits(size_t maxIdle, size_t maxRetainedBytes);
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> idle;
+    /// @brief Moving average of the response size by endpoint name
+    std::map<std::string, double, std::less<>> expectedSize;
+    size_t maxIdle;
+    size_t maxRetainedBytes;
+};
+
+#endif //USGSM2M_TRANSPORT_HPP
@@ -3,24 +3,44 @@
 /// @brief Implementation of the USGS M2M C++ basic functionality and helper functions.
 
 #include "usgsm2m.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
+#include <thread>
+
+namespace {
+
+std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+} // namespace
 
 USGS_M2M_API::USGS_M2M_API() {
     setup_curl();
 }
 
 USGS_M2M_API::~USGS_M2M_API() {
+    // Abort outstanding asynchronous transfers before curl is torn down
+    engine.reset();
     cleanup_curl();
 }
 
 void USGS_M2M_API::setAuthToken(const std::string& token) {
     updateHeader("X-Auth-Token: " + token);
+    // Cached responses may depend on the user, e.g. permissions
+    responseCache.clear();
 }
 
 void USGS_M2M_API::updateHeader(const std::string& header){
+    std::lock_guard<std::mutex> lock(headersMutex);
+
     bool foundHeader = false;
     std::string key = header.substr(0, header.find(':'));
+    std::vector<std::string> headersVector;
+    if (headers) headersVector = headers->lines;
 
     for(auto& hdr : headersVector) {
         if (hdr.substr(0, hdr.find(':')) == key) {
@@ -31,11 +51,68 @@ void USGS_M2M_API::updateHeader(const std::string& header){
     }
     if(!foundHeader) headersVector.push_back(header);
 
-    curl_slist_free_all(headers);
-    headers = nullptr;
-    for(auto& hdr : headersVector) {
-        headers = curl_slist_append(headers, hdr.c_str());
-    }
+    // Swap in a new immutable set, in-flight requests keep their own reference to the old one
+    headers = std::make_shared<const HeaderSet>(std::move(headersVector));
+}
+
+std::shared_ptr<const HeaderSet> USGS_M2M_API::currentHeaders() const {
+    std::lock_guard<std::mutex> lock(headersMutex);
+    return headers;
+}
+
+void USGS_M2M_API::setHandlePoolSize(size_t maxIdleHandles) {
+    handlePool.setMaxIdle(maxIdleHandles);
+}
+
+void USGS_M2M_API::setResponseBufferRetention(size_t maxIdleBuffers, size_t maxBufferBytes) {
+    responseBuffers.setLimits(maxIdleBuffers, maxBufferBytes);
+}
+
+void USGS_M2M_API::setBaseUrl(const std::string& url) {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    baseUrl = url;
+    if (baseUrl.empty() || baseUrl.back() != '/') baseUrl += '/';
+    responseCache.clear();
+}
+
+std::string USGS_M2M_API::getBaseUrl() const {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    return baseUrl;
+}
+
+std::string USGS_M2M_API::endpointUrl(const std::string& endpoint) const {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    return baseUrl + endpoint;
+}
+
+MetricsSnapshot USGS_M2M_API::metricsSnapshot() const {
+    return metrics.snapshot();
+}
+
+std::string USGS_M2M_API::metricsPrometheus() const {
+    return metrics.snapshot().prometheusText();
+}
+
+void USGS_M2M_API::recordMetrics(const std::string& url, const RequestTiming& timing, const ErrorResponse& errorData,
+    bool success) {
+    metrics.record(url.substr(url.find_last_of('/') + 1), timing.encode + timing.total + timing.decode,
+        static_cast<uint64_t>(timing.bytesSent), static_cast<uint64_t>(timing.bytesReceived), success, errorData.errorCode);
+}
+
+void USGS_M2M_API::setResponseRecorder(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    recordDirectory = directory;
+}
+
+void USGS_M2M_API::recordResponse(const std::string& url, const std::string& responseBody, long httpCode) const {
+    if (httpCode != 200) return;
+
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    if (recordDirectory.empty()) return;
+
+    std::string endpoint = url.substr(url.find_last_of('/') + 1);
+    std::ofstream file(recordDirectory + "/" + endpoint + ".json", std::ios::binary | std::ios::trunc);
+    file.write(responseBody.data(), static_cast<std::streamsize>(responseBody.size()));
 }
 
 size_t USGS_M2M_API::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
@@ -45,65 +122,158 @@ size_t USGS_M2M_API::WriteCallback(void* contents, size_t size, size_t nmemb, vo
     return totalSize;
 }
 
+size_t USGS_M2M_API::HeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    size_t length = size * nitems;
+    static constexpr char name[] = "content-length:";
+    constexpr size_t nameLength = sizeof(name) - 1;
+    if (!userdata || length <= nameLength) return length;
+    for (size_t i = 0; i < nameLength; ++i) {
+        if (std::tolower(static_cast<unsigned char>(buffer[i])) != name[i]) return length;
+    }
+
+    size_t contentLength = 0;
+    for (size_t i = nameLength; i < length && contentLength < ResponseBufferPool::MaxPresize; ++i) {
+        if (buffer[i] >= '0' && buffer[i] <= '9') contentLength = contentLength * 10 + static_cast<size_t>(buffer[i] - '0');
+        else if (buffer[i] != ' ') break;
+    }
+    // The compressed length when the response is encoded, still a lower bound of the decoded body
+    static_cast<std::string*>(userdata)->reserve(std::min(contentLength, ResponseBufferPool::MaxPresize));
+    return length;
+}
+
+void USGS_M2M_API::configureJsonRequest(CURL* handle,
+    const std::string& url,
+    const std::string& jsonPayload,
+    std::string& responseBody,
+    const HeaderSet& requestHeaders,
+    std::optional<RequestDeadline::Clock::time_point> deadline,
+    RequestDeadline::Clock::time_point startAt) {
+
+    struct curl_slist* headerList = requestHeaders.list;
+    curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+    if (jsonPayload.empty()) {
+        curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+    } else {
+        size_t minBytes = requestCompressionMinBytes;
+        std::string compressed;
+        if (minBytes && jsonPayload.size() >= minBytes
+            && gzipCompress(jsonPayload, compressed, requestCompressionLevel) && compressed.size() < jsonPayload.size()) {
+            // curl keeps its own copy, the compressed body does not have to outlive the transfer
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(compressed.size()));
+            curl_easy_setopt(handle, CURLOPT_COPYPOSTFIELDS, compressed.data());
+            headerList = requestHeaders.compressedBodyList;
+        } else {
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(jsonPayload.size()));
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDS, jsonPayload.c_str());
+        }
+    }
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headerList);
+    // Empty string: every encoding curl was built with, decoded before the write callback sees the bytes
+    if (responseCompression) curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &responseBody);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, &responseBody);
+    applyTimeouts(handle, url, deadline, startAt);
+
+    if (http2Multiplexing) {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        // Wait for an existing connection to confirm multiplexing rather than opening another
+        curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    }
+}
+
 bool USGS_M2M_API::performJsonPostRequest(const std::string& url,
     const std::string& jsonPayload,
     std::string& responseBody,
-    long& httpCodeOut) {
+    long& httpCodeOut,
+    RequestTiming* timing,
+    CURLcode* curlResult) {
 
-    if (!curl) setup_curl();
-    if (!curl) return false;
+    CurlHandlePool::Lease handle = handlePool.acquire();
+    if (curlResult) *curlResult = CURLE_FAILED_INIT;
+    if (!handle) return false;
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonPayload.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+    std::shared_ptr<const HeaderSet> requestHeaders = currentHeaders();
+    configureJsonRequest(handle.get(), url, jsonPayload, responseBody, *requestHeaders, RequestDeadline::current());
 
-    CURLcode res = curl_easy_perform(curl);
+    CURLcode res = executeTransfer(handle.get());
+    if (curlResult) *curlResult = res;
+    if (timing) collectTiming(handle.get(), *timing);
     if (res != CURLE_OK) return false;
 
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCodeOut);
+    curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &httpCodeOut);
+    recordResponse(url, responseBody, httpCodeOut);
     return true;
 }
 
 bool USGS_M2M_API::performJsonGetRequest(const std::string& url,
     std::string& responseBody,
-    long& httpCodeOut) {
+    long& httpCodeOut,
+    RequestTiming* timing,
+    CURLcode* curlResult) {
 
-    if (!curl) setup_curl();
-    if (!curl) return false;
+    CurlHandlePool::Lease handle = handlePool.acquire();
+    if (curlResult) *curlResult = CURLE_FAILED_INIT;
+    if (!handle) return false;
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+    std::shared_ptr<const HeaderSet> requestHeaders = currentHeaders();
+    configureJsonRequest(handle.get(), url, "", responseBody, *requestHeaders, RequestDeadline::current());
 
-    CURLcode res = curl_easy_perform(curl);
+    CURLcode res = executeTransfer(handle.get());
+    if (curlResult) *curlResult = res;
+    if (timing) collectTiming(handle.get(), *timing);
     if (res != CURLE_OK) return false;
 
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCodeOut);
+    curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &httpCodeOut);
+    recordResponse(url, responseBody, httpCodeOut);
     return true;
 }
 
+void USGS_M2M_API::collectTiming(CURL* handle, RequestTiming& timing) {
+    curl_off_t nameLookup = 0, connect = 0, appConnect = 0, preTransfer = 0, startTransfer = 0, total = 0;
+    curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME_T, &preTransfer);
+    curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+
+    // curl reports each phase as the time since the start of the request
+    timing.nameLookup = std::chrono::microseconds(nameLookup);
+    timing.connect = std::chrono::microseconds(connect > nameLookup ? connect - nameLookup : 0);
+    timing.tlsHandshake = std::chrono::microseconds(appConnect > connect ? appConnect - connect : 0);
+    timing.timeToFirstByte = std::chrono::microseconds(startTransfer);
+    timing.serverTime = std::chrono::microseconds(startTransfer > preTransfer ? startTransfer - preTransfer : 0);
+    timing.total = std::chrono::microseconds(total);
+
+    curl_off_t uploaded = 0, downloaded = 0;
+    curl_easy_getinfo(handle, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+    curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+    timing.bytesSent = uploaded;
+    timing.bytesReceived = downloaded;
+
+    // A transfer that failed before it had a connection (DNS, refused) opened none either
+    long newConnections = 0;
+    long requestBytes = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &newConnections);
+    curl_easy_getinfo(handle, CURLINFO_REQUEST_SIZE, &requestBytes);
+    timing.connectionReused = newConnections == 0 && requestBytes > 0;
+
+    curl_off_t retryAfter = 0;
+    curl_easy_getinfo(handle, CURLINFO_RETRY_AFTER, &retryAfter);
+    timing.retryAfter = std::chrono::seconds(retryAfter);
+}
+
 void USGS_M2M_API::setup_curl() {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (!curl) {
-        std::cerr << "Failed to initialize cURL." << std::endl;
-        return;
-    }
+    CurlShareCache::ensureGlobalInit();
     updateHeader("Content-Type: application/json");
     updateHeader("Accept: application/json");
 }
 
 void USGS_M2M_API::cleanup_curl() {
-    if (curl) curl_easy_cleanup(curl);
-    if (headers) curl_slist_free_all(headers);
-    headers = nullptr;
-    curl_global_cleanup();
+    // curl stays globally initialized, other clients share its caches
+    handlePool.setMaxIdle(0);
 }
 
 bool USGS_M2M_API::httpRequestSuccessful(long httpCode, bool& success, ErrorResponse& errorData) {
@@ -114,7 +284,9 @@ bool USGS_M2M_API::httpRequestSuccessful(long httpCode, bool& success, ErrorResp
 
 bool USGS_M2M_API::jsonErrorParsing(nlohmann::json& jsonResponse, ErrorResponse& errorData, bool& success) {
     if (jsonResponse.contains("errorCode") && !jsonResponse["errorCode"].is_null()) {
-        errorData.errorCode = jsonResponse["errorCode"].get<int>();
+        // M2M error codes are names such as AUTH_INVALID, only numeric codes fit errorCode
+        errorData.errorCode = safeGetIntOpt(jsonResponse, "errorCode").value_or(-1);
+        errorData.errorCodeName = safeGetStringOpt(jsonResponse, "errorCode");
         errorData.errorMessage = safeGetStringOpt(jsonResponse, "errorMessage").value_or("");
         return (success = false);
     }
@@ -127,22 +299,25 @@ void USGS_M2M_API::jsonMetaDataParsing(nlohmann::json& jsonResponse, MetaDataRes
     metaData.version = safeGetStringOpt(jsonResponse, "version");
 }
 
-DefaultResponse USGS_M2M_API::defaultJsonResponseParsing(const std::string& url, nlohmann::json& jsonResponse, const std::string& jsonPayload) {
+DefaultResponse USGS_M2M_API::parseJsonResponse(const std::string& responseBody, long httpCode, bool requestSucceeded) {
     DefaultResponse result;
+    result.success = requestSucceeded;
 
-    std::string responseBody;
-    long httpCode = 0;
-
-    if(jsonPayload.empty()){
-        result.success = performJsonGetRequest(url, responseBody, httpCode);
-    }
-    else{
-        result.success = performJsonPostRequest(url, jsonPayload, responseBody, httpCode);
+    // A failed or timed out transfer leaves a partial body at best, report the failure rather than a parse error
+    if (!requestSucceeded) {
+        result.errorData.errorCode = -1;
+        result.errorData.errorMessage = "Failed to perform HTTP request";
+        return result;
     }
+
     // Parse JSON response
+    nlohmann::json jsonResponse;
+    auto decodeStart = std::chrono::steady_clock::now();
     try {
         jsonResponse = nlohmann::json::parse(responseBody);
+        result.metaData.timing.decode = elapsedSince(decodeStart);
     } catch (const std::exception& e) {
+        result.metaData.timing.decode = elapsedSince(decodeStart);
         result.errorData.errorCode = -1;
         result.errorData.errorMessage = std::string("JSON parse error: ") + e.what();
         result.success = false;
@@ -159,9 +334,10 @@ DefaultResponse USGS_M2M_API::defaultJsonResponseParsing(const std::string& url,
 
     jsonMetaDataParsing(jsonResponse, result.metaData);
 
-    // Parse JSON Data field
-    if(jsonResponse.contains("data") && !jsonResponse["data"].is_null()) {
-        result.data = jsonResponse["data"];
+    // Parse JSON Data field, moved out since the document is dropped right after
+    auto data = jsonResponse.find("data");
+    if(data != jsonResponse.end() && !data->is_null()) {
+        result.data = std::move(*data);
     }else{
         result.success = false;
     }
@@ -169,6 +345,79 @@ DefaultResponse USGS_M2M_API::defaultJsonResponseParsing(const std::string& url,
     return result;
 }
 
+DefaultResponse USGS_M2M_API::defaultJsonResponseParsing(const std::string& endpoint, const nlohmann::json& payload) {
+    auto encodeStart = std::chrono::steady_clock::now();
+    std::string jsonPayload = payload.dump();
+
+    size_t downloadCount = 0;
+    if (endpoint == "download-request") {
+        auto downloads = payload.find("downloads");
+        if (downloads != payload.end() && downloads->is_array()) downloadCount = downloads->size();
+    }
+    return defaultJsonResponseParsing(endpoint, jsonPayload, elapsedSince(encodeStart), downloadCount);
+}
+
+DefaultResponse USGS_M2M_API::defaultJsonResponseParsing(const std::string& endpoint, const std::string& jsonPayload,
+    std::chrono::microseconds encodeTime, size_t downloadCount) {
+    DefaultResponse result;
+    std::string url = endpointUrl(endpoint);
+
+    // prepareRequest only wants the request, not the round trip
+    if (requestCapture) {
+        if (!*requestCapture) {
+            *requestCapture = PreparedRequest{url, jsonPayload, encodeTime, std::nullopt, downloadCount};
+        } else {
+            DefaultResponse error;
+            error.errorData.errorCode = -1;
+            error.errorData.errorMessage = "Only one endpoint may be called per asynchronous request.";
+            (*requestCapture)->earlyResponse = error;
+        }
+        result.errorData.errorCode = -1;
+        result.errorData.errorMessage = "Request captured, not sent.";
+        return result;
+    }
+
+    if (std::optional<DefaultResponse> cached = cachedResponse(url, jsonPayload)) return std::move(*cached);
+
+    std::shared_ptr<const RetryPolicy> policy = currentRetryPolicy();
+    std::optional<RequestDeadline::Clock::time_point> deadline = RequestDeadline::current();
+    for (int attempt = 1;; ++attempt) {
+        if (!waitForSendSlot(downloadCount, deadline)) {
+            result = DefaultResponse{};
+            result.errorData = deadlineExceeded();
+            return result;
+        }
+
+        // Taken once the request is sure to go out, a pooled buffer dropped here would be lost to the pool
+        std::string responseBody = responseBuffers.acquire(endpoint);
+        long httpCode = 0;
+        bool requestSucceeded = false;
+        CURLcode curlResult = CURLE_OK;
+        RequestTiming timing;
+
+        if(jsonPayload.empty()){
+            requestSucceeded = performJsonGetRequest(url, responseBody, httpCode, &timing, &curlResult);
+        }
+        else{
+            requestSucceeded = performJsonPostRequest(url, jsonPayload, responseBody, httpCode, &timing, &curlResult);
+        }
+
+        result = parseJsonResponse(responseBody, httpCode, requestSucceeded);
+        timing.encode = encodeTime;
+        timing.decode = result.metaData.timing.decode;
+        result.metaData.timing = timing;
+        recordMetrics(url, timing, result.errorData, result.success);
+        observeRateLimit(httpCode, result.errorData, timing);
+
+        auto delay = retryDelay(*policy, url, attempt, curlResult, httpCode, result.success, result.errorData, timing,
+            deadline);
+        if (!delay) cacheResponse(url, jsonPayload, result, responseBody);
+        responseBuffers.release(endpoint, std::move(responseBody));
+        if (!delay) return result;
+        std::this_thread::sleep_for(*delay);
+    }
+}
+
 std::optional<int> USGS_M2M_API::safeGetIntOpt(const nlohmann::json& j, const std::string& key) const {
     if (!j.contains(key)) return std::nullopt;
     if (j[key].is_number_integer()) return j[key].get<int>();
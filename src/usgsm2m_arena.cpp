@@ -0,0 +1,364 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Arena-backed sceneSearch decoding without a JSON DOM
+
+#include "usgsm2m.hpp"
+#include "usgsm2m_time.hpp"
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+/// @brief Keys the decoder cares about, everything else is skipped
+enum class Key {
+    Other, ErrorCode, ErrorMessage, RequestId, SessionId, Version, Data,
+    TotalHits, RecordsReturned, NextRecord, Results,
+    EntityId, DisplayId, OrderingId, PublishDate, CloudCover,
+    TemporalCoverage, StartDate, SpatialCoverage, SpatialBounds, Coordinates
+};
+
+Key lookupKey(const std::string& key) {
+    static const std::unordered_map<std::string, Key> keys = {
+        {"errorCode", Key::ErrorCode}, {"errorMessage", Key::ErrorMessage},
+        {"requestId", Key::RequestId}, {"sessionId", Key::SessionId},
+        {"version", Key::Version}, {"data", Key::Data},
+        {"totalHits", Key::TotalHits}, {"recordsReturned", Key::RecordsReturned},
+        {"nextRecord", Key::NextRecord}, {"results", Key::Results},
+        {"entityId", Key::EntityId}, {"displayId", Key::DisplayId},
+        {"orderingId", Key::OrderingId}, {"publishDate", Key::PublishDate},
+        {"cloudCover", Key::CloudCover}, {"temporalCoverage", Key::TemporalCoverage},
+        {"startDate", Key::StartDate}, {"spatialCoverage", Key::SpatialCoverage},
+        {"spatialBounds", Key::SpatialBounds}, {"coordinates", Key::Coordinates},
+    };
+    auto it = keys.find(key);
+    return it == keys.end() ? Key::Other : it->second;
+}
+
+/// @brief nlohmann SAX handler filling a SceneArenaResponse
+class SceneArenaSax {
+public:
+    explicit SceneArenaSax(SceneArenaResponse& out) : out(out) {
+        // Missing IDs read as 0, as in the JSON decoder
+        metaData.version = std::nullopt;
+        metaData.requestId = 0;
+        metaData.sessionId = 0;
+    }
+
+    bool null() { return value(Value{}); }
+    bool boolean(bool) { return true; }
+    bool number_integer(nlohmann::json::number_integer_t v) { return value(Value::number(static_cast<double>(v))); }
+    bool number_unsigned(nlohmann::json::number_unsigned_t v) { return value(Value::number(static_cast<double>(v))); }
+    bool number_float(nlohmann::json::number_float_t v, const std::string&) { return value(Value::number(v)); }
+    bool string(std::string& v) { return value(Value::text(&v)); }
+    bool binary(nlohmann::json::binary_t&) { return true; }
+
+    bool key(std::string& k) {
+        stack.back().key = lookupKey(k);
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        if (stack.size() == 1 && stack[0].key == Key::Data) hasData = true;
+        if (inResults() && stack.size() == 3) {
+            scene = &out.addScene();
+            coverageFootprint = false;
+        }
+        if (scene && stack.size() == 4) {
+            Key k = stack[3].key;
+            if (k == Key::SpatialCoverage || (k == Key::SpatialBounds && !coverageFootprint)) {
+                collecting = true;
+                ringDone = false;
+                pointLength = 0;
+                scene->footprint.clear();
+                if (k == Key::SpatialCoverage) coverageFootprint = true;
+            }
+        }
+        stack.push_back({false, Key::Other});
+        return true;
+    }
+
+    bool end_object() {
+        stack.pop_back();
+        if (scene && stack.size() == 4) collecting = false;
+        if (stack.size() == 3) scene = nullptr;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        if (stack.size() == 1 && stack[0].key == Key::Data) hasData = true;
+        stack.push_back({true, Key::Other});
+        return true;
+    }
+
+    bool end_array() {
+        stack.pop_back();
+        if (!collecting) return true;
+        if (pointLength > 0) {
+            // A [lon, lat] pair just closed
+            if (!ringDone && pointLength >= 2) scene->footprint.push_back({point[0], point[1]});
+            pointLength = 0;
+        } else if (!scene->footprint.empty()) {
+            // The first ring closed, later rings and polygons are holes or extra parts
+            ringDone = true;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) {
+        errorText = std::string("JSON parse error: ") + e.what();
+        return false;
+    }
+
+    std::string errorText;
+    /// @brief Root errorCode, only set when it is not null
+    std::optional<int> errorCode;
+    std::optional<std::string> errorCodeName;
+    std::string errorMessage;
+    MetaDataResponse metaData;
+    bool hasData = false;
+
+private:
+    struct Level {
+        bool isArray;
+        Key key;
+    };
+
+    struct Value {
+        bool isNull = true;
+        bool isNumber = false;
+        double number_ = 0;
+        const std::string* string_ = nullptr;
+
+        static Value number(double v) { Value r; r.isNull = false; r.isNumber = true; r.number_ = v; return r; }
+        static Value text(const std::string* v) { Value r; r.isNull = false; r.string_ = v; return r; }
+
+        std::optional<int> asInt() const {
+            if (isNumber) return static_cast<int>(number_);
+            if (string_) {
+                try { return std::stoi(*string_); } catch (...) {}
+            }
+            return std::nullopt;
+        }
+    };
+
+    bool inResults() const {
+        return stack.size() >= 3 && stack[0].key == Key::Data && stack[1].key == Key::Results && stack[2].isArray;
+    }
+
+    bool value(const Value& v) {
+        if (stack.empty()) return true;
+        Level& level = stack.back();
+
+        if (collecting && level.isArray) {
+            if (v.isNumber && pointLength < 2) point[pointLength] = v.number_;
+            if (v.isNumber) ++pointLength;
+            return true;
+        }
+        if (level.isArray) return true;
+
+        switch (stack.size()) {
+        case 1:
+            rootValue(level.key, v);
+            break;
+        case 2:
+            if (stack[0].key == Key::Data) dataValue(level.key, v);
+            break;
+        case 4:
+            if (scene) sceneValue(level.key, v);
+            break;
+        case 5:
+            if (scene && stack[3].key == Key::TemporalCoverage && level.key == Key::StartDate && v.string_) {
+                scene->acquisitionDate = parseM2MTime(*v.string_);
+            }
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    void rootValue(Key key, const Value& v) {
+        switch (key) {
+        case Key::ErrorCode:
+            if (!v.isNull) errorCode = v.asInt().value_or(-1);
+            if (v.string_) errorCodeName = *v.string_;
+            break;
+        case Key::ErrorMessage:
+            if (v.string_) errorMessage = *v.string_;
+            break;
+        case Key::Data:
+            if (!v.isNull) hasData = true;
+            break;
+        case Key::RequestId:
+            metaData.requestId = v.asInt().value_or(0);
+            break;
+        case Key::SessionId:
+            metaData.sessionId = v.asInt().value_or(0);
+            break;
+        case Key::Version:
+            if (v.string_) metaData.version = *v.string_;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void dataValue(Key key, const Value& v) {
+        if (key == Key::TotalHits) out.totalHits = v.asInt().value_or(0);
+        else if (key == Key::RecordsReturned) out.recordsReturned = v.asInt().value_or(0);
+        else if (key == Key::NextRecord) out.nextRecord = v.asInt();
+    }
+
+    void sceneValue(Key key, const Value& v) {
+        switch (key) {
+        case Key::EntityId:
+            if (v.string_) scene->entityId = out.store(*v.string_);
+            break;
+        case Key::DisplayId:
+            if (v.string_) scene->displayId = out.store(*v.string_);
+            break;
+        case Key::OrderingId:
+            if (v.string_) scene->orderingId = out.store(*v.string_);
+            break;
+        case Key::PublishDate:
+            if (v.string_) scene->publishDate = parseM2MTime(*v.string_);
+            break;
+        case Key::CloudCover: {
+            std::optional<float> cover;
+            if (v.isNumber) cover = static_cast<float>(v.number_);
+            else if (v.string_) {
+                try { cover = std::stof(*v.string_); } catch (...) {}
+            }
+            if (cover && *cover >= 0) scene->cloudCover = cover;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    SceneArenaResponse& out;
+    std::vector<Level> stack;
+    SceneView* scene = nullptr;
+    bool collecting = false;
+    bool ringDone = false;
+    bool coverageFootprint = false;
+    double point[2] = {0, 0};
+    size_t pointLength = 0;
+};
+
+} // namespace
+
+/**********************************  SceneArenaResponse ***********************************************/
+
+SceneArenaResponse::SceneArenaResponse()
+    : arena(std::make_unique<std::pmr::monotonic_buffer_resource>()),
+      scenes(std::make_unique<std::pmr::vector<SceneView>>(arena.get())) {}
+
+const std::pmr::vector<SceneView>& SceneArenaResponse::results() const {
+    static const std::pmr::vector<SceneView> movedFrom;
+    return scenes ? *scenes : movedFrom;
+}
+
+std::string_view SceneArenaResponse::store(const std::string& text) {
+    if (text.empty()) return {};
+    char* copy = static_cast<char*>(arena->allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+SceneView& SceneArenaResponse::addScene() {
+    return scenes->emplace_back(arena.get());
+}
+
+void SceneArenaResponse::parse(const std::string& responseBody, long httpCode, bool requestSucceeded) {
+    success = requestSucceeded;
+    if (!success) {
+        errorData.errorCode = -1;
+        errorData.errorMessage = "Failed to perform HTTP request";
+        return;
+    }
+
+    SceneArenaSax handler(*this);
+    bool parsed = nlohmann::json::sax_parse(responseBody, &handler);
+    if (!parsed) {
+        errorData.errorCode = -1;
+        errorData.errorMessage = handler.errorText.empty() ? "JSON parse error" : handler.errorText;
+        success = false;
+        return;
+    }
+
+    // Same order of checks as parseJsonResponse
+    if (!success) {
+        errorData.errorCode = -1;
+        errorData.errorMessage = "Failed to perform HTTP request";
+    }
+    if (httpCode != 200) {
+        errorData.errorCode = -1;
+        errorData.errorMessage = "HTTP error code: " + std::to_string(httpCode);
+        success = false;
+    }
+    if (!success) return;
+
+    if (handler.errorCode) {
+        errorData.errorCode = handler.errorCode;
+        errorData.errorCodeName = std::move(handler.errorCodeName);
+        errorData.errorMessage = std::move(handler.errorMessage);
+        success = false;
+        return;
+    }
+    metaData = std::move(handler.metaData);
+    if (!handler.hasData) success = false;
+}
+
+/**********************************  Arena API Functions ***********************************************/
+
+SceneArenaResponse USGS_M2M_API::sceneSearchArena(
+    const std::string& datasetName,
+    int maxResults,
+    int startingNumber,
+    const SceneSearchOptions& options
+) {
+    SceneArenaResponse result;
+
+    PreparedRequest request = prepareRequest([&](USGS_M2M_API& client) {
+        return client.sceneSearchPage(datasetName, maxResults, startingNumber, options);
+    });
+    if (request.earlyResponse) {
+        result.errorData = request.earlyResponse->errorData;
+        return result;
+    }
+
+    std::shared_ptr<const RetryPolicy> policy = currentRetryPolicy();
+    std::optional<RequestDeadline::Clock::time_point> deadline = RequestDeadline::current();
+    std::string_view endpoint = std::string_view(request.url).substr(request.url.find_last_of('/') + 1);
+    for (int attempt = 1;; ++attempt) {
+        if (!waitForSendSlot(0, deadline)) {
+            result = SceneArenaResponse();
+            result.errorData = deadlineExceeded();
+            return result;
+        }
+        std::string responseBody = responseBuffers.acquire(endpoint);
+        long httpCode = 0;
+        CURLcode curlResult = CURLE_OK;
+        RequestTiming timing;
+        bool requestSucceeded = performJsonPostRequest(request.url, request.jsonPayload, responseBody, httpCode, &timing,
+            &curlResult);
+
+        result = SceneArenaResponse();
+        auto decodeStart = std::chrono::steady_clock::now();
+        result.parse(responseBody, httpCode, requestSucceeded);
+        responseBuffers.release(endpoint, std::move(responseBody));
+        timing.encode = request.encodeTime;
+        timing.decode = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - decodeStart);
+        result.metaData.timing = timing;
+        recordMetrics(request.url, timing, result.errorData, result.success);
+        observeRateLimit(httpCode, result.errorData, timing);
+
+        auto delay = retryDelay(*policy, request.url, attempt, curlResult, httpCode, result.success, result.errorData, timing,
+            deadline);
+        if (!delay) return result;
+        std::this_thread::sleep_for(*delay);
+    }
+}
@@ -0,0 +1,394 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the curl multi event loop and the asynchronous USGS M2M API calls
+
+#include "usgsm2m.hpp"
+#include <algorithm>
+
+thread_local std::optional<PreparedRequest>* USGS_M2M_API::requestCapture = nullptr;
+
+/// @brief Everything an asynchronous request must keep alive until curl is done with it
+struct USGS_M2M_API::AsyncTransfer {
+    PreparedRequest request;
+    ResponseCallback onComplete;
+    std::shared_ptr<const RetryPolicy> retryPolicy;
+    /// @brief Deadline in scope when the request was submitted
+    std::optional<RequestDeadline::Clock::time_point> deadline;
+    int attempt = 0;
+    /// @brief Rate limiter slot of the current attempt
+    SendSlot slot;
+    /// @brief Set when pacing the attempt again after a limit error pushed it past the deadline
+    bool deadlineMissed = false;
+    std::string responseBody;
+    std::shared_ptr<const HeaderSet> headers;
+    CurlHandlePool::Lease handle;
+};
+
+namespace {
+
+/// @brief Restores the previous capture target even if the endpoint call throws
+struct CaptureScope {
+    std::optional<PreparedRequest>*& slot;
+    std::optional<PreparedRequest>* previous;
+
+    CaptureScope(std::optional<PreparedRequest>*& slot, std::optional<PreparedRequest>* target)
+        : slot(slot), previous(slot) { slot = target; }
+    ~CaptureScope() { slot = previous; }
+};
+
+DefaultResponse failedResponse(const std::string& message) {
+    DefaultResponse result;
+    result.success = false;
+    result.errorData.errorCode = -1;
+    result.errorData.errorMessage = message;
+    return result;
+}
+
+/// @brief Invoke a completion on the engine thread or in the destructor, where a throwing callback
+/// must neither take the event loop down nor reach std::terminate
+void complete(const CurlMultiEngine::Completion& onDone, CURL* handle, CURLcode result) {
+    try {
+        onDone(handle, result);
+    } catch (...) {
+    }
+}
+
+} // namespace
+
+/**********************************  CurlMultiEngine ***********************************************/
+
+CurlMultiEngine::CurlMultiEngine(size_t maxInFlight)
+    : maxInFlight(maxInFlight ? maxInFlight : 1) {
+    multi = curl_multi_init();
+    if (multi) curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+}
+
+CurlMultiEngine::~CurlMultiEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    if (multi) curl_multi_wakeup(multi);
+    if (worker.joinable()) worker.join();
+
+    // Nothing runs the loop anymore, fail whatever is left
+    for (auto& [handle, onDone] : running) {
+        curl_multi_remove_handle(multi, handle);
+        complete(onDone, handle, CURLE_ABORTED_BY_CALLBACK);
+    }
+    running.clear();
+    for (auto& transfer : pending) {
+        complete(transfer.onDone, transfer.handle, CURLE_ABORTED_BY_CALLBACK);
+    }
+    pending.clear();
+    for (auto& [start, transfer] : delayed) {
+        complete(transfer.onDone, transfer.handle, CURLE_ABORTED_BY_CALLBACK);
+    }
+    delayed.clear();
+
+    if (multi) curl_multi_cleanup(multi);
+}
+
+void CurlMultiEngine::submit(CURL* handle, Completion onDone, std::chrono::steady_clock::time_point notBefore,
+    StartCheck check) {
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopping && multi) {
+            if (notBefore > std::chrono::steady_clock::now()) {
+                delayed.emplace(notBefore, Transfer{handle, std::move(onDone), std::move(check)});
+            } else {
+                pending.push_back({handle, std::move(onDone), std::move(check)});
+            }
+            if (!worker.joinable()) worker = std::thread(&CurlMultiEngine::run, this);
+            queued = true;
+        }
+    }
+    if (!queued) {
+        onDone(handle, CURLE_FAILED_INIT);
+        return;
+    }
+    curl_multi_wakeup(multi);
+}
+
+void CurlMultiEngine::setMaxInFlight(size_t limit) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxInFlight = limit ? limit : 1;
+    }
+    if (multi) curl_multi_wakeup(multi);
+}
+
+void CurlMultiEngine::setMaxHostConnections(long maxConnections) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxHostConnections = maxConnections;
+        multiOptionsChanged = true;
+    }
+    if (multi) curl_multi_wakeup(multi);
+}
+
+bool CurlMultiEngine::onEngineThread() const {
+    return std::this_thread::get_id() == workerId.load();
+}
+
+void CurlMultiEngine::applyMultiOptions() {
+    long connections = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!multiOptionsChanged) return;
+        multiOptionsChanged = false;
+        connections = maxHostConnections;
+    }
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, connections);
+}
+
+void CurlMultiEngine::run() {
+    workerId = std::this_thread::get_id();
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) break;
+        }
+        applyMultiOptions();
+        attachPending();
+
+        int stillRunning = 0;
+        curl_multi_perform(multi, &stillRunning);
+        collectFinished();
+
+        // Sleeps until a socket is ready, a delayed transfer is due or submit() wakes us up
+        curl_multi_poll(multi, nullptr, 0, pollTimeoutMs(), nullptr);
+    }
+}
+
+int CurlMultiEngine::pollTimeoutMs() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (delayed.empty()) return 1000;
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(delayed.begin()->first - std::chrono::steady_clock::now());
+    return static_cast<int>(std::clamp<long long>(wait.count(), 0, 1000));
+}
+
+void CurlMultiEngine::attachPending() {
+    std::deque<Transfer> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = std::chrono::steady_clock::now();
+        while (!delayed.empty() && delayed.begin()->first <= now) {
+            pending.push_back(std::move(delayed.begin()->second));
+            delayed.erase(delayed.begin());
+        }
+        while (!pending.empty() && running.size() + ready.size() < maxInFlight) {
+            ready.push_back(std::move(pending.front()));
+            pending.pop_front();
+        }
+    }
+    for (auto& transfer : ready) {
+        if (transfer.check) {
+            std::chrono::steady_clock::time_point start = transfer.check(transfer.handle);
+            if (start == std::chrono::steady_clock::time_point::max()) {
+                complete(transfer.onDone, transfer.handle, CURLE_OPERATION_TIMEDOUT);
+                continue;
+            }
+            if (start > std::chrono::steady_clock::now()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                delayed.emplace(start, std::move(transfer));
+                continue;
+            }
+        }
+        if (curl_multi_add_handle(multi, transfer.handle) != CURLM_OK) {
+            complete(transfer.onDone, transfer.handle, CURLE_FAILED_INIT);
+            continue;
+        }
+        running.emplace(transfer.handle, std::move(transfer.onDone));
+    }
+}
+
+void CurlMultiEngine::collectFinished() {
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+
+        CURL* handle = msg->easy_handle;
+        CURLcode result = msg->data.result;
+        curl_multi_remove_handle(multi, handle);
+
+        auto it = running.find(handle);
+        if (it == running.end()) continue;
+        Completion onDone = std::move(it->second);
+        running.erase(it);
+
+        complete(onDone, handle, result);
+    }
+}
+
+/**********************************  Asynchronous API Functions ***********************************************/
+
+CurlMultiEngine& USGS_M2M_API::asyncEngine() {
+    std::call_once(engineOnce, [this]() {
+        engine = std::make_unique<CurlMultiEngine>(maxConcurrentRequests);
+        if (http2Multiplexing) engine->setMaxHostConnections(http2MaxConnections);
+    });
+    return *engine;
+}
+
+bool USGS_M2M_API::setHttp2Multiplexing(bool enabled, long maxConnections) {
+    if (enabled) {
+        curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+        if (!info || !(info->features & CURL_VERSION_HTTP2)) return false;
+    }
+
+    long limit = maxConnections > 0 ? maxConnections : 1;
+    http2Multiplexing = enabled;
+    http2MaxConnections = limit;
+    asyncEngine().setMaxHostConnections(enabled ? limit : 0);
+    return true;
+}
+
+CURLcode USGS_M2M_API::executeTransfer(CURL* handle) {
+    // A blocking call from a completion callback cannot wait on its own event loop
+    if (!http2Multiplexing || asyncEngine().onEngineThread()) {
+        return curl_easy_perform(handle);
+    }
+
+    // Run on the shared multi handle so concurrent blocking calls become streams of one connection
+    std::promise<CURLcode> done;
+    std::future<CURLcode> result = done.get_future();
+    asyncEngine().submit(handle, [&done](CURL*, CURLcode res) { done.set_value(res); });
+    return result.get();
+}
+
+void USGS_M2M_API::setMaxConcurrentRequests(size_t maxRequests) {
+    size_t limit = maxRequests ? maxRequests : 1;
+    maxConcurrentRequests = limit;
+    asyncEngine().setMaxInFlight(limit);
+}
+
+PreparedRequest USGS_M2M_API::prepareRequest(const ApiCall& call) {
+    std::optional<PreparedRequest> captured;
+    DefaultResponse returned;
+    {
+        CaptureScope scope(requestCapture, &captured);
+        returned = call(*this);
+    }
+
+    if (!captured) {
+        PreparedRequest request;
+        request.earlyResponse = std::move(returned);
+        return request;
+    }
+    return std::move(*captured);
+}
+
+std::future<DefaultResponse> USGS_M2M_API::submitAsync(const ApiCall& call) {
+    auto promise = std::make_shared<std::promise<DefaultResponse>>();
+    std::future<DefaultResponse> future = promise->get_future();
+
+    submitAsync(call, [promise](DefaultResponse response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+void USGS_M2M_API::submitAsync(const ApiCall& call, ResponseCallback onComplete) {
+    PreparedRequest request = prepareRequest(call);
+    if (request.earlyResponse) {
+        onComplete(std::move(*request.earlyResponse));
+        return;
+    }
+    if (std::optional<DefaultResponse> cached = cachedResponse(request.url, request.jsonPayload)) {
+        onComplete(std::move(*cached));
+        return;
+    }
+
+    auto transfer = std::make_shared<AsyncTransfer>();
+    transfer->request = std::move(request);
+    transfer->onComplete = std::move(onComplete);
+    transfer->retryPolicy = currentRetryPolicy();
+    transfer->deadline = RequestDeadline::current();
+    startAsyncAttempt(transfer, std::chrono::steady_clock::time_point{});
+}
+
+void USGS_M2M_API::startAsyncAttempt(const std::shared_ptr<AsyncTransfer>& transfer,
+    std::chrono::steady_clock::time_point notBefore) {
+
+    ++transfer->attempt;
+    const auto& deadline = transfer->deadline;
+    if (deadline && std::max(notBefore, RateLimiter::Clock::now()) >= *deadline) {
+        transfer->onComplete(failedResponse(deadlineExceeded().errorMessage));
+        return;
+    }
+
+    // The rate limiter may hold the request back, the engine starts it when its slot comes
+    transfer->slot = reserveSendSlot(transfer->request.downloadCount);
+    RateLimiter::Clock::time_point sendSlot = std::max(notBefore, transfer->slot.at);
+    if (deadline && sendSlot >= *deadline) {
+        cancelSendSlot(transfer->slot);
+        transfer->onComplete(failedResponse(deadlineExceeded().errorMessage));
+        return;
+    }
+
+    transfer->handle = handlePool.acquire();
+    if (!transfer->handle) {
+        cancelSendSlot(transfer->slot);
+        transfer->onComplete(failedResponse("Failed to initialize cURL."));
+        return;
+    }
+
+    const std::string& url = transfer->request.url;
+    transfer->responseBody = responseBuffers.acquire(std::string_view(url).substr(url.find_last_of('/') + 1));
+    transfer->headers = currentHeaders();
+    configureJsonRequest(transfer->handle.get(), transfer->request.url, transfer->request.jsonPayload,
+        transfer->responseBody, *transfer->headers, deadline, std::max(sendSlot, RateLimiter::Clock::now()));
+
+    // A limit error while the transfer waits in the engine writes its slot off, it is paced again then
+    auto repace = [this, transfer](CURL* handle) {
+        if (!sendSlotStale(transfer->slot)) return RateLimiter::Clock::time_point{};
+        cancelSendSlot(transfer->slot);
+        transfer->slot = reserveSendSlot(transfer->request.downloadCount);
+        const auto& deadline = transfer->deadline;
+        if (deadline && transfer->slot.at >= *deadline) {
+            cancelSendSlot(transfer->slot);
+            transfer->deadlineMissed = true;
+            return RateLimiter::Clock::time_point::max();
+        }
+        applyTimeouts(handle, transfer->request.url, deadline, std::max(transfer->slot.at, RateLimiter::Clock::now()));
+        return transfer->slot.at;
+    };
+
+    asyncEngine().submit(transfer->handle.get(), [this, transfer](CURL* done, CURLcode res) {
+        if (transfer->deadlineMissed) {
+            transfer->handle.reset();
+            const std::string& url = transfer->request.url;
+            responseBuffers.release(std::string_view(url).substr(url.find_last_of('/') + 1), std::move(transfer->responseBody));
+            transfer->onComplete(failedResponse(deadlineExceeded().errorMessage));
+            return;
+        }
+
+        long httpCode = 0;
+        if (res == CURLE_OK) curl_easy_getinfo(done, CURLINFO_RESPONSE_CODE, &httpCode);
+        RequestTiming timing;
+        collectTiming(done, timing);
+        transfer->handle.reset();
+        recordResponse(transfer->request.url, transfer->responseBody, httpCode);
+
+        DefaultResponse response = parseJsonResponse(transfer->responseBody, httpCode, res == CURLE_OK);
+        timing.encode = transfer->request.encodeTime;
+        timing.decode = response.metaData.timing.decode;
+        response.metaData.timing = timing;
+        recordMetrics(transfer->request.url, timing, response.errorData, response.success);
+        observeRateLimit(httpCode, response.errorData, timing);
+
+        auto delay = retryDelay(*transfer->retryPolicy, transfer->request.url, transfer->attempt, res, httpCode,
+            response.success, response.errorData, timing, transfer->deadline);
+        const std::string& url = transfer->request.url;
+        if (!delay) cacheResponse(url, transfer->request.jsonPayload, response, transfer->responseBody);
+        responseBuffers.release(std::string_view(url).substr(url.find_last_of('/') + 1), std::move(transfer->responseBody));
+        if (delay) {
+            // Scheduled on the event loop, the engine thread never sleeps
+            startAsyncAttempt(transfer, std::chrono::steady_clock::now() + *delay);
+            return;
+        }
+        transfer->onComplete(std::move(response));
+    }, sendSlot, repace);
+}
@@ -0,0 +1,154 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the in-memory response cache
+
+#include "usgsm2m.hpp"
+
+namespace {
+
+std::string cacheKey(std::string_view endpoint, const std::string& payload) {
+    std::string key;
+    key.reserve(endpoint.size() + 1 + payload.size());
+    key.append(endpoint);
+    key += ' ';
+    key += payload;
+    return key;
+}
+
+} // namespace
+
+/**********************************  ResponseCache ***********************************************/
+
+void ResponseCache::configure(const ResponseCacheConfig& newConfig, bool enable) {
+    std::lock_guard<std::mutex> lock(mutex);
+    config = newConfig;
+    enabled = enable && config.maxBytes > 0;
+    index.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+bool ResponseCache::cacheable(std::string_view endpoint) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return enabled && config.endpoints.count(endpoint) > 0;
+}
+
+std::shared_ptr<const DefaultResponse> ResponseCache::lookup(std::string_view endpoint, const std::string& payload) {
+    std::string key = cacheKey(endpoint, payload);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) return nullptr;
+
+    auto it = index.find(key);
+    if (it == index.end() || Clock::now() >= it->second->expires) {
+        if (it != index.end()) erase(it->second);
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->response;
+}
+
+void ResponseCache::store(std::string_view endpoint, const std::string& payload, const DefaultResponse& response,
+    size_t responseBytes) {
+
+    if (!response.success) return;
+    std::string key = cacheKey(endpoint, payload);
+    size_t entryBytes = key.size() + responseBytes;
+    // Copied before taking the lock, the data can be large
+    auto copy = std::make_shared<const DefaultResponse>(response);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled || entryBytes > config.maxBytes) return;
+
+    auto existing = index.find(key);
+    if (existing != index.end()) erase(existing->second);
+    while (!entries.empty() && bytes + entryBytes > config.maxBytes) {
+        erase(std::prev(entries.end()));
+        ++evictions;
+    }
+
+    entries.push_front(Entry{std::move(key), std::move(copy), entryBytes, Clock::now() + config.ttl});
+    index.emplace(entries.front().key, entries.begin());
+    bytes += entryBytes;
+}
+
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    index.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ResponseCacheStats current;
+    current.hits = hits;
+    current.misses = misses;
+    current.evictions = evictions;
+    current.entries = entries.size();
+    current.bytes = bytes;
+    return current;
+}
+
+void ResponseCache::erase(std::list<Entry>::iterator entry) {
+    bytes -= entry->bytes;
+    index.erase(entry->key);
+    entries.erase(entry);
+}
+
+/**********************************  Response Cache API Functions ***********************************************/
+
+void USGS_M2M_API::setResponseCache(const ResponseCacheConfig& config) {
+    responseCache.configure(config, true);
+}
+
+void USGS_M2M_API::disableResponseCache() {
+    responseCache.configure(ResponseCacheConfig(), false);
+}
+
+void USGS_M2M_API::clearResponseCache() {
+    responseCache.clear();
+}
+
+ResponseCacheStats USGS_M2M_API::responseCacheStats() const {
+    return responseCache.stats();
+}
+
+std::optional<DefaultResponse> USGS_M2M_API::cachedResponse(const std::string& url, const std::string& payload) {
+    std::string_view endpoint = std::string_view(url).substr(url.find_last_of('/') + 1);
+    bool inMemory = responseCache.cacheable(endpoint);
+    if (inMemory) {
+        if (std::shared_ptr<const DefaultResponse> cached = responseCache.lookup(endpoint, payload)) {
+            DefaultResponse result = *cached;
+            result.metaData.fromCache = true;
+            result.metaData.timing = RequestTiming();
+            return result;
+        }
+    }
+
+    std::shared_ptr<DiskCache> disk = currentDiskCache();
+    if (!disk || !disk->cacheable(endpoint)) return std::nullopt;
+    std::optional<std::string> body = disk->lookup(url + ' ' + payload);
+    if (!body) return std::nullopt;
+
+    DefaultResponse result = parseJsonResponse(*body, 200, true);
+    if (!result.success) return std::nullopt;
+    if (inMemory) responseCache.store(endpoint, payload, result, body->size());
+    result.metaData.fromCache = true;
+    std::chrono::microseconds decode = result.metaData.timing.decode;
+    result.metaData.timing = RequestTiming();
+    result.metaData.timing.decode = decode;
+    return result;
+}
+
+void USGS_M2M_API::cacheResponse(const std::string& url, const std::string& payload, const DefaultResponse& response,
+    const std::string& responseBody) {
+    if (!response.success) return;
+    std::string_view endpoint = std::string_view(url).substr(url.find_last_of('/') + 1);
+    if (responseCache.cacheable(endpoint)) responseCache.store(endpoint, payload, response, responseBody.size());
+
+    std::shared_ptr<DiskCache> disk = currentDiskCache();
+    if (disk && disk->cacheable(endpoint)) disk->store(url + ' ' + payload, responseBody);
+}
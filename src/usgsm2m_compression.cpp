@@ -0,0 +1,37 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of response compression negotiation and gzip request bodies
+
+#include "usgsm2m.hpp"
+#include <zlib.h>
+#include <limits>
+
+/**********************************  Compression API Functions ***********************************************/
+
+void USGS_M2M_API::setResponseCompression(bool enabled) {
+    responseCompression = enabled;
+}
+
+void USGS_M2M_API::setRequestCompression(size_t minBytes, int level) {
+    requestCompressionLevel = level < 1 || level > 9 ? Z_DEFAULT_COMPRESSION : level;
+    requestCompressionMinBytes = minBytes;
+}
+
+bool USGS_M2M_API::gzipCompress(const std::string& input, std::string& output, int level) {
+    if (input.size() > std::numeric_limits<uInt>::max()) return false;
+
+    z_stream zs{};
+    // 15 window bits plus 16 selects the gzip wrapper instead of raw zlib
+    if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+
+    output.resize(deflateBound(&zs, static_cast<uLong>(input.size())) + 32);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zs.avail_in = static_cast<uInt>(input.size());
+    zs.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    zs.avail_out = static_cast<uInt>(output.size());
+
+    int status = deflate(&zs, Z_FINISH);
+    output.resize(zs.total_out);
+    deflateEnd(&zs);
+    return status == Z_STREAM_END;
+}
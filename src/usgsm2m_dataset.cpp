@@ -18,9 +18,7 @@ DefaultResponse USGS_M2M_API::dataset(const std::string& datasetName, const std:
     if (!datasetName.empty()) requestJson["datasetName"] = datasetName;
     if (!datasetId.empty()) requestJson["datasetId"] = datasetId;
 
-    std::string jsonPayload = requestJson.dump();
-    
-    return defaultJsonResponseParsing(API_URL + "dataset", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetBrowse(const std::string& datasetId) {
@@ -36,28 +34,20 @@ DefaultResponse USGS_M2M_API::datasetBrowse(const std::string& datasetId) {
     nlohmann::json requestJson;
     requestJson["datasetId"] = datasetId;
 
-    std::string jsonPayload = requestJson.dump();
-    
-    return defaultJsonResponseParsing(API_URL + "dataset-browse", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-browse", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetBulkProducts(const std::string& datasetName) {
 
-    DefaultResponse result;
-
     nlohmann::json requestJson;
     if (!datasetName.empty()) requestJson["datasetName"] = datasetName;
 
-    std::string jsonPayload = requestJson.dump();
-    
-    return defaultJsonResponseParsing(API_URL + "dataset-bulk-products", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-bulk-products", requestJson);
 
 }
 
 DefaultResponse USGS_M2M_API::datasetCatalogs() {
-    DefaultResponse result;
-
-    return defaultJsonResponseParsing(API_URL + "dataset-catalogs", result.data);
+    return defaultJsonResponseParsing("dataset-catalogs");
 }
 
 DefaultResponse USGS_M2M_API::datasetCategories(
@@ -68,8 +58,6 @@ DefaultResponse USGS_M2M_API::datasetCategories(
     const std::optional<std::string>& parentId,
     const std::optional<std::string>& datasetFilter
 ) {
-    DefaultResponse result;
-
     nlohmann::json requestJson;
     if(catalog) requestJson["catalog"] = *catalog;
     if(includeMessages) requestJson["includeMessages"] = *includeMessages;
@@ -78,9 +66,7 @@ DefaultResponse USGS_M2M_API::datasetCategories(
     if(parentId) requestJson["parentId"] = *parentId;
     if(datasetFilter) requestJson["datasetFilter"] = *datasetFilter;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-categories", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-categories", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetClearCustomization(
@@ -88,17 +74,13 @@ DefaultResponse USGS_M2M_API::datasetClearCustomization(
     const std::vector<std::string>& metadataType,
     const std::vector<std::string>& fileGroupIds
 ) {
-    DefaultResponse result;
-
     nlohmann::json requestJson;
 
     if(datasetName) requestJson["datasetName"] = *datasetName;
     if(!metadataType.empty()) requestJson["metadataType"] = metadataType;
     if(!fileGroupIds.empty()) requestJson["fileGroupIds"] = fileGroupIds;
 
-    std::string jsonPayload = requestJson.dump();
-    
-    return defaultJsonResponseParsing(API_URL + "dataset-clear-customization", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-clear-customization", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetCoverage(const std::string& datasetName) {
@@ -114,9 +96,7 @@ DefaultResponse USGS_M2M_API::datasetCoverage(const std::string& datasetName) {
     nlohmann::json requestJson;
     requestJson["datasetName"] = datasetName;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-coverage", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-coverage", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetDownloadOptions(
@@ -136,8 +116,7 @@ DefaultResponse USGS_M2M_API::datasetDownloadOptions(
     requestJson["datasetName"] = datasetName;
     if (sceneFilter) requestJson["sceneFilter"] = *sceneFilter;
 
-    std::string jsonPayload = requestJson.dump();
-    return defaultJsonResponseParsing(API_URL + "dataset-download-options", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-download-options", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetFileGroups(const std::string& datasetName) {
@@ -153,8 +132,7 @@ DefaultResponse USGS_M2M_API::datasetFileGroups(const std::string& datasetName)
     nlohmann::json requestJson;
     requestJson["datasetName"] = datasetName;
 
-    std::string jsonPayload = requestJson.dump();
-    return defaultJsonResponseParsing(API_URL + "dataset-file-groups", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-file-groups", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetFilters(const std::string& datasetName) {
@@ -170,8 +148,7 @@ DefaultResponse USGS_M2M_API::datasetFilters(const std::string& datasetName) {
     nlohmann::json requestJson;
     requestJson["datasetName"] = datasetName;
 
-    std::string jsonPayload = requestJson.dump();
-    return defaultJsonResponseParsing(API_URL + "dataset-filters", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-filters", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetGetCustomization(const std::string& datasetName) {
@@ -187,25 +164,19 @@ DefaultResponse USGS_M2M_API::datasetGetCustomization(const std::string& dataset
     nlohmann::json requestJson;
     requestJson["datasetName"] = datasetName;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-get-customization", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-get-customization", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetGetCustomizations(
     const std::vector<std::string>& datasetNames,
     const std::vector<std::string>& metadataType
 ) {
-    DefaultResponse result;
-
     nlohmann::json requestJson;
 
     if (!datasetNames.empty()) requestJson["datasetNames"] = datasetNames;
     if (!metadataType.empty()) requestJson["metadataType"] = metadataType;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-get-customizations", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-get-customizations", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetMessages(
@@ -213,17 +184,13 @@ DefaultResponse USGS_M2M_API::datasetMessages(
     const std::optional<std::string>& datasetName,
     const std::vector<std::string>& datasetNames
 ) {
-    DefaultResponse result;
-
     nlohmann::json requestJson;
 
     if (catalog) requestJson["catalog"] = *catalog;
     if (datasetName) requestJson["datasetName"] = *datasetName;
     if (!datasetNames.empty()) requestJson["datasetNames"] = datasetNames;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-messages", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-messages", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetMetadata(const std::string& datasetName) {
@@ -239,9 +206,7 @@ DefaultResponse USGS_M2M_API::datasetMetadata(const std::string& datasetName) {
     nlohmann::json requestJson;
     requestJson["datasetName"] = datasetName;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-metadata", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-metadata", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetOrderProducts(const std::string& datasetName) {
@@ -257,9 +222,7 @@ DefaultResponse USGS_M2M_API::datasetOrderProducts(const std::string& datasetNam
     nlohmann::json requestJson;
     requestJson["datasetName"] = datasetName;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-order-products", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-order-products", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetSearch(
@@ -275,8 +238,6 @@ DefaultResponse USGS_M2M_API::datasetSearch(
     const std::optional<std::string>& sortField,
     const std::optional<bool>& useCustomization
 ) {
-    DefaultResponse result;
-
     nlohmann::json requestJson;
     if(catalog) requestJson["catalog"] = *catalog;
     if(categoryId) requestJson["categoryId"] = *categoryId;
@@ -290,9 +251,7 @@ DefaultResponse USGS_M2M_API::datasetSearch(
     if(sortField) requestJson["sortField"] = *sortField;
     if(useCustomization) requestJson["useCustomization"] = *useCustomization;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-search", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-search", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetSetCustomization(
@@ -318,14 +277,10 @@ DefaultResponse USGS_M2M_API::datasetSetCustomization(
     if(searchSort) requestJson["searchSort"] = *searchSort;
     if(fileGroups) requestJson["fileGroups"] = *fileGroups;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "dataset-set-customization", result.data, jsonPayload);
+    return defaultJsonResponseParsing("dataset-set-customization", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::datasetSetCustomizations(const std::vector<DatasetCustomization>& customizations) {
-    DefaultResponse result;
-
     nlohmann::json jsonRequest;
     nlohmann::json datasetJson;
 
@@ -340,7 +295,7 @@ DefaultResponse USGS_M2M_API::datasetSetCustomizations(const std::vector<Dataset
         jsonRequest["datasetCustomization"] = std::move(datasetJson);
     }
 
-    return defaultJsonResponseParsing(API_URL + "dataset-set-customizations", result.data, jsonRequest.dump());
+    return defaultJsonResponseParsing("dataset-set-customizations", jsonRequest);
 }
 
 nlohmann::json USGS_M2M_API::datasetCustomizationToJson(const DatasetCustomization& dc) {
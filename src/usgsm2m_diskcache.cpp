@@ -0,0 +1,364 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the persistent disk cache shared across processes
+
+#include "usgsm2m.hpp"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t IndexMagic = 0x48434143444d324dULL; // "M2MDCACH" in little-endian byte order
+constexpr uint32_t IndexVersion = 1;
+constexpr uint64_t EmptySlot = 0;
+constexpr uint64_t Tombstone = 1;
+
+/// @brief FNV-1a, moved clear of the two reserved slot markers
+uint64_t keyHash(const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash > Tombstone ? hash : hash + 2;
+}
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/// @brief flock held for a scope, orders the processes sharing the cache
+class FileLock {
+public:
+    FileLock(int fd, int operation) : fd(fd) {
+        while (::flock(fd, operation) != 0 && errno == EINTR) {}
+    }
+    ~FileLock() { ::flock(fd, LOCK_UN); }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+    int fd;
+};
+
+/// @brief Start of every record in a segment, followed by the key and the value
+struct RecordHeader {
+    uint64_t hash;
+    uint32_t keyLength;
+    uint32_t valueLength;
+};
+
+bool readAll(int fd, void* data, size_t size, off_t offset) {
+    char* out = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = ::pread(fd, out, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+bool writeAll(int fd, const void* data, size_t size, off_t offset) {
+    const char* in = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, in, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        in += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+} // namespace
+
+/// @brief Start of the index file, shared by every process through the mapping
+struct DiskCache::IndexHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    /// @brief Segments [oldestSegment, activeSegment] exist, records are appended to activeSegment
+    uint64_t oldestSegment;
+    uint64_t activeSegment;
+    uint64_t activeBytes;
+    uint64_t totalBytes;
+    uint64_t entries;
+    uint64_t tombstones;
+};
+
+/// @brief One entry of the open-addressing table following the header
+struct DiskCache::IndexSlot {
+    /// @brief Key hash, EmptySlot or Tombstone
+    uint64_t hash;
+    /// @brief Unix time the entry stops being served
+    int64_t expires;
+    uint64_t segment;
+    uint64_t offset;
+    uint64_t recordBytes;
+};
+
+/**********************************  DiskCache ***********************************************/
+
+DiskCache::DiskCache(const DiskCacheConfig& cacheConfig) : config(cacheConfig) {
+    if (config.directory.empty()) {
+        openError = "No disk cache directory given.";
+        return;
+    }
+    if (::mkdir(config.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        openError = "Cannot create " + config.directory + ": " + std::strerror(errno);
+        return;
+    }
+
+    std::string path = config.directory + "/index";
+    indexFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (indexFd < 0) {
+        openError = "Cannot open " + path + ": " + std::strerror(errno);
+        return;
+    }
+
+    // Exclusive while checking, so two processes never initialize the index at once
+    FileLock lock(indexFd, LOCK_EX);
+    IndexHeader header{};
+    struct stat info {};
+    bool valid = ::fstat(indexFd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(IndexHeader)
+        && readAll(indexFd, &header, sizeof(header), 0) && header.magic == IndexMagic
+        && header.version == IndexVersion && header.slotCount > 0
+        && static_cast<size_t>(info.st_size) == sizeof(IndexHeader) + header.slotCount * sizeof(IndexSlot);
+
+    if (!valid) {
+        // New or unreadable: start over, segments are truncated as they are written again
+        header = IndexHeader{};
+        header.magic = IndexMagic;
+        header.version = IndexVersion;
+        header.slotCount = std::max<uint32_t>(config.slots, 64);
+        size_t bytes = sizeof(IndexHeader) + header.slotCount * sizeof(IndexSlot);
+        if (::ftruncate(indexFd, 0) != 0 || ::ftruncate(indexFd, static_cast<off_t>(bytes)) != 0
+            || !writeAll(indexFd, &header, sizeof(header), 0)) {
+            openError = "Cannot initialize " + path + ": " + std::strerror(errno);
+            return;
+        }
+    }
+
+    indexBytes = sizeof(IndexHeader) + header.slotCount * sizeof(IndexSlot);
+    void* mapping = ::mmap(nullptr, indexBytes, PROT_READ | PROT_WRITE, MAP_SHARED, indexFd, 0);
+    if (mapping == MAP_FAILED) {
+        openError = "Cannot map " + path + ": " + std::strerror(errno);
+        return;
+    }
+    index = static_cast<IndexHeader*>(mapping);
+    slots = reinterpret_cast<IndexSlot*>(index + 1);
+}
+
+DiskCache::~DiskCache() {
+    if (index) ::munmap(index, indexBytes);
+    if (indexFd >= 0) ::close(indexFd);
+}
+
+bool DiskCache::cacheable(std::string_view endpoint) const {
+    return index && config.endpoints.count(endpoint) > 0;
+}
+
+std::optional<std::string> DiskCache::lookup(const std::string& key) {
+    uint64_t hash = keyHash(key);
+    IndexSlot found{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index) {
+            FileLock fileLock(indexFd, LOCK_SH);
+            IndexSlot* slot = findSlot(hash, false);
+            if (slot && slot->expires > unixNow()) found = *slot;
+        }
+    }
+    if (found.hash == EmptySlot) {
+        ++misses;
+        return std::nullopt;
+    }
+
+    // Read without the locks: segments are never rewritten in place, an evicted one is gone as a whole
+    std::optional<std::string> value;
+    int fd = ::open(segmentPath(found.segment).c_str(), O_RDONLY | O_CLOEXEC);
+    RecordHeader record{};
+    if (fd >= 0 && readAll(fd, &record, sizeof(record), static_cast<off_t>(found.offset)) && record.hash == hash
+        && record.keyLength == key.size()
+        && sizeof(record) + static_cast<uint64_t>(record.keyLength) + record.valueLength == found.recordBytes) {
+
+        std::string stored(found.recordBytes - sizeof(record), '\0');
+        if (readAll(fd, &stored[0], stored.size(), static_cast<off_t>(found.offset + sizeof(record)))
+            && stored.compare(0, key.size(), key) == 0) {
+            stored.erase(0, key.size());
+            value = std::move(stored);
+        }
+    }
+    if (fd >= 0) ::close(fd);
+
+    if (value) ++hits;
+    else ++misses;
+    return value;
+}
+
+void DiskCache::store(const std::string& key, const std::string& value) {
+    if (!index) return;
+    uint64_t segmentBytes = std::max<uint64_t>(1, config.maxBytes / SegmentCount);
+    uint64_t recordBytes = sizeof(RecordHeader) + key.size() + value.size();
+    if (recordBytes > segmentBytes || value.size() > UINT32_MAX) return;
+
+    RecordHeader header{keyHash(key), static_cast<uint32_t>(key.size()), static_cast<uint32_t>(value.size())};
+    std::string record;
+    record.reserve(recordBytes);
+    record.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    record += key;
+    record += value;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    FileLock fileLock(indexFd, LOCK_EX);
+
+    if (index->activeBytes > 0 && index->activeBytes + recordBytes > segmentBytes) {
+        ++index->activeSegment;
+        index->activeBytes = 0;
+    }
+    while (index->totalBytes + recordBytes > config.maxBytes && index->oldestSegment < index->activeSegment) {
+        evictOldestSegment();
+    }
+
+    // Keep the table at most three quarters full so probe sequences stay short
+    uint64_t slotLimit = static_cast<uint64_t>(index->slotCount) * 3 / 4;
+    while (index->entries + 1 > slotLimit && index->oldestSegment < index->activeSegment) evictOldestSegment();
+    if (index->entries + index->tombstones + 1 > slotLimit) rehash();
+    if (index->entries + 1 > slotLimit) return;
+
+    // A fresh segment may be a leftover of an index that was started over
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (index->activeBytes == 0 ? O_TRUNC : 0);
+    int fd = ::open(segmentPath(index->activeSegment).c_str(), flags, 0644);
+    if (fd < 0) return;
+    bool written = writeAll(fd, record.data(), record.size(), static_cast<off_t>(index->activeBytes));
+    ::close(fd);
+    if (!written) return;
+
+    IndexSlot* slot = findSlot(header.hash, true);
+    if (slot->hash != header.hash) {
+        // An overwritten record stays in its segment until the segment is evicted
+        if (slot->hash == Tombstone) --index->tombstones;
+        ++index->entries;
+    }
+    *slot = IndexSlot{header.hash, unixNow() + config.ttl.count(), index->activeSegment, index->activeBytes, recordBytes};
+    index->activeBytes += recordBytes;
+    index->totalBytes += recordBytes;
+}
+
+void DiskCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!index) return;
+    FileLock fileLock(indexFd, LOCK_EX);
+
+    for (uint64_t segment = index->oldestSegment; segment <= index->activeSegment; ++segment) {
+        ::unlink(segmentPath(segment).c_str());
+    }
+    std::memset(slots, 0, index->slotCount * sizeof(IndexSlot));
+    index->oldestSegment = index->activeSegment = index->activeSegment + 1;
+    index->activeBytes = index->totalBytes = index->entries = index->tombstones = 0;
+}
+
+DiskCacheStats DiskCache::stats() const {
+    DiskCacheStats current;
+    current.hits = hits;
+    current.misses = misses;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!index) return current;
+    FileLock fileLock(indexFd, LOCK_SH);
+    current.entries = index->entries;
+    current.bytes = index->totalBytes;
+    return current;
+}
+
+DiskCache::IndexSlot* DiskCache::findSlot(uint64_t hash, bool forInsert) const {
+    uint32_t count = index->slotCount;
+    IndexSlot* firstFree = nullptr;
+    for (uint32_t probe = 0, position = static_cast<uint32_t>(hash % count); probe < count;
+         ++probe, position = position + 1 == count ? 0 : position + 1) {
+        IndexSlot& slot = slots[position];
+        if (slot.hash == hash) return &slot;
+        if (slot.hash == Tombstone) {
+            if (!firstFree) firstFree = &slot;
+        } else if (slot.hash == EmptySlot) {
+            if (!forInsert) return nullptr;
+            return firstFree ? firstFree : &slot;
+        }
+    }
+    return forInsert ? firstFree : nullptr;
+}
+
+void DiskCache::evictOldestSegment() {
+    uint64_t segment = index->oldestSegment++;
+    for (uint32_t i = 0; i < index->slotCount; ++i) {
+        IndexSlot& slot = slots[i];
+        if (slot.hash > Tombstone && slot.segment == segment) {
+            slot.hash = Tombstone;
+            --index->entries;
+            ++index->tombstones;
+        }
+    }
+
+    std::string path = segmentPath(segment);
+    struct stat info {};
+    if (::stat(path.c_str(), &info) == 0) {
+        index->totalBytes -= std::min<uint64_t>(index->totalBytes, static_cast<uint64_t>(info.st_size));
+    }
+    ::unlink(path.c_str());
+}
+
+void DiskCache::rehash() {
+    std::vector<IndexSlot> live;
+    live.reserve(index->entries);
+    for (uint32_t i = 0; i < index->slotCount; ++i) {
+        if (slots[i].hash > Tombstone) live.push_back(slots[i]);
+    }
+    std::memset(slots, 0, index->slotCount * sizeof(IndexSlot));
+    for (const IndexSlot& entry : live) *findSlot(entry.hash, true) = entry;
+    index->tombstones = 0;
+}
+
+std::string DiskCache::segmentPath(uint64_t segment) const {
+    return config.directory + "/segment-" + std::to_string(segment) + ".dat";
+}
+
+/**********************************  Disk Cache API Functions ***********************************************/
+
+bool USGS_M2M_API::setDiskCache(const DiskCacheConfig& config) {
+    auto cache = std::make_shared<DiskCache>(config);
+    bool opened = cache->isOpen();
+    std::lock_guard<std::mutex> lock(diskCacheMutex);
+    diskCache = opened ? std::move(cache) : nullptr;
+    return opened;
+}
+
+void USGS_M2M_API::disableDiskCache() {
+    std::lock_guard<std::mutex> lock(diskCacheMutex);
+    diskCache.reset();
+}
+
+void USGS_M2M_API::clearDiskCache() {
+    if (std::shared_ptr<DiskCache> cache = currentDiskCache()) cache->clear();
+}
+
+DiskCacheStats USGS_M2M_API::diskCacheStats() const {
+    std::shared_ptr<DiskCache> cache = currentDiskCache();
+    return cache ? cache->stats() : DiskCacheStats();
+}
+
+std::shared_ptr<DiskCache> USGS_M2M_API::currentDiskCache() const {
+    std::lock_guard<std::mutex> lock(diskCacheMutex);
+    return diskCache;
+}
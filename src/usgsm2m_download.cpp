@@ -24,17 +24,13 @@ DefaultResponse USGS_M2M_API::downloadCompleteProxied(const std::vector<ProxiedD
         requestJson["proxiedDownloads"].push_back(std::move(entry));
     }
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-complete-proxied", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-complete-proxied", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::downloadEula(
     const std::optional<std::string>& eulaCode,
     const std::vector<std::string>& eulaCodes
 ) {
-    DefaultResponse result;
-
     nlohmann::json requestJson;
 
     if (eulaCode) {
@@ -45,22 +41,16 @@ DefaultResponse USGS_M2M_API::downloadEula(
         requestJson["eulaCodes"] = eulaCodes;
     }
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-eula", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-eula", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::downloadLabels(const std::optional<std::string>& downloadApplication) {
-    DefaultResponse result;
-
     nlohmann::json requestJson;
     if (downloadApplication) {
         requestJson["downloadApplication"] = *downloadApplication;
     }
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-labels", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-labels", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::downloadOptions(
@@ -85,9 +75,7 @@ DefaultResponse USGS_M2M_API::downloadOptions(
     if (listId) requestJson["listId"] = *listId;
     if (includeSecondaryFileGroups) requestJson["includeSecondaryFileGroups"] = *includeSecondaryFileGroups;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-options", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-options", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::downloadOrderLoad(
@@ -108,9 +96,7 @@ DefaultResponse USGS_M2M_API::downloadOrderLoad(
     if (label) requestJson["label"] = *label;
     if (downloadApplication) requestJson["downloadApplication"] = *downloadApplication;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-order-load", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-order-load", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::downloadOrderRemove(
@@ -130,9 +116,7 @@ DefaultResponse USGS_M2M_API::downloadOrderRemove(
     requestJson["label"] = label;
     if (downloadApplication) requestJson["downloadApplication"] = *downloadApplication;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-order-remove", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-order-remove", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::downloadRemove(int downloadId) {
@@ -148,9 +132,7 @@ DefaultResponse USGS_M2M_API::downloadRemove(int downloadId) {
     nlohmann::json requestJson;
     requestJson["downloadId"] = downloadId;
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-remove", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-remove", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::downloadRequest(
@@ -162,7 +144,6 @@ DefaultResponse USGS_M2M_API::downloadRequest(
     const std::optional<std::string>& systemId,
     const std::optional<std::vector<FilegroupDownload>>& dataGroups
 ) {
-    DefaultResponse result;
     nlohmann::json payload;
 
     if (configurationCode) payload["configurationCode"] = *configurationCode;
@@ -229,16 +210,13 @@ DefaultResponse USGS_M2M_API::downloadRequest(
         }
     }
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-request", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-request", payload);
 }
 
 DefaultResponse USGS_M2M_API::downloadRetrieve(
     const std::optional<std::string>& label,
     const std::optional<std::string>& downloadApplication
 ) {
-    DefaultResponse result;
     nlohmann::json payload;
 
     // Only include parameters if they are provided
@@ -249,9 +227,7 @@ DefaultResponse USGS_M2M_API::downloadRetrieve(
         payload["downloadApplication"] = *downloadApplication;
     }
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-retrieve", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-retrieve", payload);
 }
 
 DefaultResponse USGS_M2M_API::downloadSearch(
@@ -260,7 +236,6 @@ DefaultResponse USGS_M2M_API::downloadSearch(
     const std::optional<std::string>& downloadApplication,
     const std::optional<bool>& includeArchived
 ) {
-    DefaultResponse result;
     nlohmann::json payload;
 
     if (activeOnly) payload["activeOnly"] = *activeOnly;
@@ -268,9 +243,7 @@ DefaultResponse USGS_M2M_API::downloadSearch(
     if (downloadApplication) payload["downloadApplication"] = *downloadApplication;
     if (includeArchived) payload["includeArchived"] = *includeArchived;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-search", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-search", payload);
 }
 
 DefaultResponse USGS_M2M_API::downloadSummary(
@@ -301,7 +274,5 @@ DefaultResponse USGS_M2M_API::downloadSummary(
         payload["sendEmail"] = *sendEmail;
     }
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "download-summary", result.data, jsonPayload);
+    return defaultJsonResponseParsing("download-summary", payload);
 }
\ No newline at end of file
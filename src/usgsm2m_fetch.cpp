@@ -0,0 +1,612 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the parallel ranged download engine
+
+#include "usgsm2m_fetch.hpp"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <unistd.h>
+
+/// @brief Results of one fetch call, filled in from the engine thread
+struct DownloadEngine::Batch {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<DownloadResult> results;
+    size_t remaining = 0;
+    /// @brief Set by fetchAsync, receives each result instead of results
+    std::function<void(DownloadResult&&)> onDone;
+};
+
+/// @brief State of one file. Only the engine thread touches it once the probe is submitted.
+struct DownloadEngine::FileTransfer {
+    std::shared_ptr<Batch> batch;
+    size_t job = 0;
+    DownloadJob request;
+    /// @brief URL after redirects, the ranges go there directly
+    std::string url;
+    std::string path;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point lastProgress;
+    CurlHandlePool::Lease probe;
+    /// @brief File size from the probe's Content-Range, -1 if not sent
+    long long rangeTotal = -1;
+    std::string dispositionName;
+    /// @brief ETag, or Last-Modified if the server sent no ETag, tells a resumed file apart from a changed one
+    std::string validator;
+    /// @brief If-Range with the validator, sent with every range so a changed file is not stitched together
+    std::unique_ptr<HeaderSet> rangeHeaders;
+    DownloadJournal journal;
+    long long resumedBytes = 0;
+    long long totalBytes = -1;
+    bool ranged = false;
+    std::shared_ptr<DownloadSink> sink;
+    bool sinkOpen = false;
+    /// @brief Start of the first range not handed out yet
+    long long nextOffset = 0;
+    long long written = 0;
+    int inFlight = 0;
+    bool streamStarted = false;
+    bool failed = false;
+    bool finished = false;
+    std::string error;
+};
+
+/// @brief One range of a file, kept across its attempts
+struct DownloadEngine::ChunkTransfer {
+    std::shared_ptr<FileTransfer> file;
+    /// @brief First byte not journaled yet
+    long long start = 0;
+    /// @brief Next byte to write, a retry requests the range from here
+    long long position = 0;
+    /// @brief End of the range, exclusive, -1 for a stream of unknown size
+    long long end = -1;
+    int attempt = 0;
+    bool statusChecked = false;
+    /// @brief Content-Range of the response, first and last byte, -1 if not sent
+    long long rangeFirst = -1;
+    long long rangeLast = -1;
+    /// @brief File size of the response's Content-Range, -1 if not sent or unknown
+    long long rangeTotal = -1;
+    std::string error;
+    CurlHandlePool::Lease handle;
+};
+
+namespace {
+
+constexpr long MaxRedirects = 10;
+constexpr std::chrono::milliseconds RetryBackoff{500};
+
+bool startsWithIgnoreCase(std::string_view text, std::string_view prefix) {
+    if (text.size() < prefix.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(text[i])) != std::tolower(static_cast<unsigned char>(prefix[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Last path segment, never a directory reference, empty if nothing usable is left
+std::string safeFileName(std::string_view name) {
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string_view::npos) name.remove_prefix(slash + 1);
+    if (name == "." || name == "..") return std::string();
+    return std::string(name);
+}
+
+/// @brief filename of a Content-Disposition value, e.g. attachment; filename="LC08_L2SP.tar"
+std::string dispositionFileName(std::string_view value) {
+    size_t key = value.find("filename=");
+    if (key == std::string_view::npos) return std::string();
+    value.remove_prefix(key + 9);
+    if (!value.empty() && value.front() == '"') {
+        value.remove_prefix(1);
+        value = value.substr(0, value.find('"'));
+    } else {
+        value = value.substr(0, value.find_first_of("; \r\n"));
+    }
+    return safeFileName(value);
+}
+
+/// @brief Header value without the surrounding whitespace and line end
+std::string_view headerValue(std::string_view value) {
+    size_t first = value.find_first_not_of(" \t");
+    if (first == std::string_view::npos) return std::string_view();
+    size_t last = value.find_last_not_of(" \t\r\n");
+    return value.substr(first, last - first + 1);
+}
+
+/// @brief First and last byte and size of a Content-Range value "bytes first-last/size", -1 for what is missing or "*"
+void parseContentRange(std::string_view value, long long& first, long long& last, long long& size) {
+    first = last = size = -1;
+    value = headerValue(value);
+    if (!startsWithIgnoreCase(value, "bytes ")) return;
+    std::string text(value.substr(6));
+    char* end = nullptr;
+    if (!text.empty() && text.front() != '*') {
+        first = std::strtoll(text.c_str(), &end, 10);
+        if (*end == '-') last = std::strtoll(end + 1, &end, 10);
+    }
+    size_t slash = text.find('/');
+    if (slash != std::string::npos && slash + 1 < text.size() && text[slash + 1] != '*') {
+        size = std::strtoll(text.c_str() + slash + 1, nullptr, 10);
+    }
+}
+
+/// @brief Validator usable in If-Range: a strong ETag or a Last-Modified date. Weak ETags never match there.
+std::string ifRangeValue(const std::string& validator) {
+    if (startsWithIgnoreCase(validator, "ETag W/")) return std::string();
+    size_t space = validator.find(' ');
+    return space == std::string::npos ? std::string() : validator.substr(space + 1);
+}
+
+std::string urlFileName(std::string_view url) {
+    url = url.substr(0, url.find_first_of("?#"));
+    size_t scheme = url.find("://");
+    if (scheme != std::string_view::npos) url.remove_prefix(scheme + 3);
+    size_t path = url.find('/');
+    if (path == std::string_view::npos) return std::string();
+    return safeFileName(url.substr(path));
+}
+
+} // namespace
+
+/**********************************  DownloadEngine ***********************************************/
+
+DownloadEngine::DownloadEngine(const DownloadOptions& downloadOptions)
+    : options(downloadOptions),
+      handlePool(std::max<size_t>(downloadOptions.maxConnections, 1), &CurlShareCache::instance()),
+      engine(downloadOptions.maxConnections) {
+    options.connectionsPerFile = std::max(options.connectionsPerFile, 1);
+    options.maxChunkAttempts = std::max(options.maxChunkAttempts, 1);
+    options.chunkBytes = std::max(options.chunkBytes, 64LL << 10);
+}
+
+std::vector<DownloadResult> DownloadEngine::fetch(const std::vector<DownloadJob>& jobs) {
+    auto batch = std::make_shared<Batch>();
+    batch->results.resize(jobs.size());
+    batch->remaining = jobs.size();
+    for (size_t i = 0; i < jobs.size(); ++i) startFile(batch, i, jobs[i]);
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&batch]() { return batch->remaining == 0; });
+    return std::move(batch->results);
+}
+
+DownloadResult DownloadEngine::fetch(const DownloadJob& job) {
+    return std::move(fetch(std::vector<DownloadJob>{job}).front());
+}
+
+void DownloadEngine::fetchAsync(const DownloadJob& job, std::function<void(DownloadResult&&)> onDone) {
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = 1;
+    batch->onDone = std::move(onDone);
+    startFile(batch, 0, job);
+}
+
+void DownloadEngine::startFile(const std::shared_ptr<Batch>& batch, size_t job, const DownloadJob& request) {
+    auto file = std::make_shared<FileTransfer>();
+    file->batch = batch;
+    file->job = job;
+    file->request = request;
+    file->url = request.url;
+    file->started = std::chrono::steady_clock::now();
+    startProbe(file);
+}
+
+std::vector<DownloadJob> DownloadEngine::jobsFromResponse(const nlohmann::json& data, const std::string& directory,
+    bool includePreparing) {
+
+    std::string prefix = directory;
+    if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+
+    std::vector<DownloadJob> jobs;
+    std::vector<const char*> keys{"availableDownloads", "available"};
+    if (includePreparing) keys.push_back("preparingDownloads");
+    for (const char* key : keys) {
+        auto list = data.find(key);
+        if (list == data.end() || !list->is_array()) continue;
+        for (const auto& entry : *list) {
+            if (!entry.is_object()) continue;
+            auto url = entry.find("url");
+            if (url == entry.end() || !url->is_string() || url->get_ref<const std::string&>().empty()) continue;
+
+            DownloadJob job;
+            job.url = url->get<std::string>();
+            job.path = prefix;
+            auto id = entry.find("downloadId");
+            if (id != entry.end() && id->is_number_integer()) job.downloadId = id->get<long long>();
+            bool seen = std::any_of(jobs.begin(), jobs.end(), [&job](const DownloadJob& other) {
+                return other.url == job.url;
+            });
+            if (!seen) jobs.push_back(std::move(job));
+        }
+    }
+    return jobs;
+}
+
+void DownloadEngine::startProbe(const std::shared_ptr<FileTransfer>& file) {
+    if (file->request.url.empty()) {
+        failFile(*file, "'url' cannot be empty.");
+        finishIfDone(file);
+        return;
+    }
+    file->probe = handlePool.acquire();
+    if (!file->probe) {
+        failFile(*file, "Failed to initialize cURL.");
+        finishIfDone(file);
+        return;
+    }
+
+    // A one byte range rather than HEAD: presigned storage URLs are often only signed for GET
+    CURL* handle = file->probe.get();
+    curl_easy_setopt(handle, CURLOPT_URL, file->url.c_str());
+    curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(handle, CURLOPT_RANGE, "0-0");
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_MAXREDIRS, MaxRedirects);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(options.connectTimeout.count()));
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, options.lowSpeedBytes);
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(options.lowSpeedTime.count()));
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, ProbeHeaderCallback);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, file.get());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, ProbeWriteCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, file.get());
+
+    engine.submit(handle, [this, file](CURL*, CURLcode result) { onProbed(file, result); });
+}
+
+size_t DownloadEngine::ProbeHeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    size_t total = size * nitems;
+    auto& file = *static_cast<FileTransfer*>(userdata);
+    std::string_view line(buffer, total);
+
+    // Every response of a redirect chain starts over
+    if (startsWithIgnoreCase(line, "HTTP/")) {
+        file.rangeTotal = -1;
+        file.dispositionName.clear();
+        file.validator.clear();
+    } else if (startsWithIgnoreCase(line, "Content-Range:")) {
+        long long first = -1, last = -1;
+        parseContentRange(line.substr(14), first, last, file.rangeTotal);
+    } else if (startsWithIgnoreCase(line, "Content-Disposition:")) {
+        file.dispositionName = dispositionFileName(line.substr(20));
+    } else if (startsWithIgnoreCase(line, "ETag:")) {
+        file.validator = "ETag " + std::string(headerValue(line.substr(5)));
+    } else if (startsWithIgnoreCase(line, "Last-Modified:") && file.validator.empty()) {
+        file.validator = "Last-Modified " + std::string(headerValue(line.substr(14)));
+    }
+    return total;
+}
+
+size_t DownloadEngine::ProbeWriteCallback(char*, size_t size, size_t nmemb, void* userdata) {
+    auto& file = *static_cast<FileTransfer*>(userdata);
+    long httpCode = 0;
+    curl_easy_getinfo(file.probe.get(), CURLINFO_RESPONSE_CODE, &httpCode);
+    // A server ignoring the range sends the whole file, stop right after the headers
+    if (httpCode == 200) return 0;
+    return size * nmemb;
+}
+
+void DownloadEngine::onProbed(const std::shared_ptr<FileTransfer>& file, CURLcode result) {
+    long httpCode = 0;
+    curl_off_t contentLength = -1;
+    char* effectiveUrl = nullptr;
+    curl_easy_getinfo(file->probe.get(), CURLINFO_RESPONSE_CODE, &httpCode);
+    curl_easy_getinfo(file->probe.get(), CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+    curl_easy_getinfo(file->probe.get(), CURLINFO_EFFECTIVE_URL, &effectiveUrl);
+    if (effectiveUrl) file->url = effectiveUrl;
+    file->probe.reset();
+
+    if ((httpCode == 206 || httpCode == 416) && file->rangeTotal >= 0 && result == CURLE_OK) {
+        file->ranged = true;
+        file->totalBytes = file->rangeTotal;
+        std::string ifRange = ifRangeValue(file->validator);
+        if (!ifRange.empty()) file->rangeHeaders = std::make_unique<HeaderSet>(std::vector<std::string>{"If-Range: " + ifRange});
+    } else if ((httpCode == 206 || httpCode == 416) && result == CURLE_OK) {
+        // Ranges work but the size is unknown ("bytes 0-0/*"), a single stream of the whole file still does
+        file->totalBytes = -1;
+    } else if (httpCode == 200 && (result == CURLE_OK || result == CURLE_WRITE_ERROR)) {
+        file->totalBytes = contentLength;
+    } else if (result != CURLE_OK) {
+        failFile(*file, curl_easy_strerror(result));
+    } else {
+        failFile(*file, "HTTP request failed with status " + std::to_string(httpCode) + ".");
+    }
+    if (file->failed) {
+        finishIfDone(file);
+        return;
+    }
+
+    file->path = file->request.path;
+    if (file->path.empty() || file->path.back() == '/') {
+        std::string name = !file->dispositionName.empty() ? file->dispositionName : urlFileName(file->url);
+        if (name.empty()) name = "download-" + std::to_string(file->request.downloadId);
+        file->path += name;
+    }
+
+    file->sink = file->request.sink;
+    if (!file->sink) {
+        std::string journalPath = file->path + ".journal";
+        if (options.resume && file->ranged && file->totalBytes > 0) {
+            // The journal only counts together with the bytes it describes
+            bool havePart = ::access((file->path + ".part").c_str(), F_OK) == 0;
+            file->journal.open(journalPath, file->totalBytes, file->validator, havePart);
+            file->resumedBytes = file->journal.completedBytes();
+            file->written = file->resumedBytes;
+        } else {
+            ::unlink(journalPath.c_str());
+        }
+
+        FileSinkOptions sinkOptions;
+        sinkOptions.keepExisting = file->resumedBytes > 0;
+        sinkOptions.keepOnFailure = file->journal.isOpen();
+        sinkOptions.direct = options.directIO;
+        file->sink = std::make_shared<FileSink>(file->path, sinkOptions);
+    }
+
+    std::string error;
+    file->sinkOpen = true;
+    if (!file->sink->open(file->totalBytes, error)) failFile(*file, error);
+
+    startChunks(file);
+    finishIfDone(file);
+}
+
+void DownloadEngine::startChunks(const std::shared_ptr<FileTransfer>& file) {
+    if (file->failed) return;
+
+    if (!file->ranged) {
+        if (file->streamStarted || file->totalBytes == 0) return;
+        file->streamStarted = true;
+        auto chunk = std::make_shared<ChunkTransfer>();
+        chunk->file = file;
+        chunk->end = file->totalBytes;
+        submitChunk(chunk, std::chrono::steady_clock::time_point{});
+        return;
+    }
+
+    while (file->inFlight < options.connectionsPerFile && !file->failed) {
+        // Ranges of an earlier run are skipped, a chunk never reaches into one
+        file->nextOffset = file->journal.nextMissing(file->nextOffset);
+        if (file->nextOffset >= file->totalBytes) break;
+        auto chunk = std::make_shared<ChunkTransfer>();
+        chunk->file = file;
+        chunk->start = file->nextOffset;
+        chunk->position = file->nextOffset;
+        chunk->end = std::min({file->nextOffset + options.chunkBytes, file->totalBytes,
+            file->journal.nextCompleted(file->nextOffset)});
+        file->nextOffset = chunk->end;
+        submitChunk(chunk, std::chrono::steady_clock::time_point{});
+    }
+}
+
+void DownloadEngine::submitChunk(const std::shared_ptr<ChunkTransfer>& chunk,
+    std::chrono::steady_clock::time_point notBefore) {
+
+    FileTransfer& file = *chunk->file;
+    ++chunk->attempt;
+    chunk->statusChecked = false;
+    chunk->rangeFirst = chunk->rangeLast = chunk->rangeTotal = -1;
+    chunk->error.clear();
+    chunk->handle = handlePool.acquire();
+    if (!chunk->handle) {
+        failFile(file, "Failed to initialize cURL.");
+        return;
+    }
+
+    CURL* handle = chunk->handle.get();
+    curl_easy_setopt(handle, CURLOPT_URL, file.url.c_str());
+    curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+    if (file.ranged) {
+        std::string range = std::to_string(chunk->position) + "-" + std::to_string(chunk->end - 1);
+        curl_easy_setopt(handle, CURLOPT_RANGE, range.c_str());
+        if (file.rangeHeaders) curl_easy_setopt(handle, CURLOPT_HTTPHEADER, file.rangeHeaders->list);
+        curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, ChunkHeaderCallback);
+        curl_easy_setopt(handle, CURLOPT_HEADERDATA, chunk.get());
+    }
+    // Each range on a connection of its own, HTTP/2 would multiplex them onto one
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_MAXREDIRS, MaxRedirects);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(options.connectTimeout.count()));
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, options.lowSpeedBytes);
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(options.lowSpeedTime.count()));
+    curl_easy_setopt(handle, CURLOPT_BUFFERSIZE, options.receiveBufferBytes);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, ChunkWriteCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, chunk.get());
+
+    ++file.inFlight;
+    engine.submit(handle, [this, chunk](CURL*, CURLcode result) { onChunkDone(chunk, result); }, notBefore);
+}
+
+size_t DownloadEngine::ChunkHeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    size_t total = size * nitems;
+    auto& chunk = *static_cast<ChunkTransfer*>(userdata);
+    std::string_view line(buffer, total);
+    if (startsWithIgnoreCase(line, "HTTP/")) {
+        chunk.rangeFirst = chunk.rangeLast = chunk.rangeTotal = -1;
+    } else if (startsWithIgnoreCase(line, "Content-Range:")) {
+        parseContentRange(line.substr(14), chunk.rangeFirst, chunk.rangeLast, chunk.rangeTotal);
+    }
+    return total;
+}
+
+size_t DownloadEngine::ChunkWriteCallback(char* data, size_t size, size_t nmemb, void* userdata) {
+    size_t total = size * nmemb;
+    auto& chunk = *static_cast<ChunkTransfer*>(userdata);
+    FileTransfer& file = *chunk.file;
+    if (file.failed) return 0;
+
+    if (!chunk.statusChecked) {
+        long httpCode = 0;
+        curl_easy_getinfo(chunk.handle.get(), CURLINFO_RESPONSE_CODE, &httpCode);
+        long expected = file.ranged ? 206 : 200;
+        if (file.ranged && httpCode == 200 && file.rangeHeaders) {
+            // If-Range did not match: the whole file came back because it changed since the probe
+            file.failed = true;
+            file.error = "File changed on the server during the download.";
+            return 0;
+        }
+        if (httpCode != expected) {
+            chunk.error = "HTTP request failed with status " + std::to_string(httpCode) + ".";
+            return 0;
+        }
+        // The bytes are written where they were asked for, so they have to be exactly that range
+        if (file.ranged && (chunk.rangeFirst != chunk.position || chunk.rangeLast != chunk.end - 1)) {
+            chunk.error = "Server answered with a different range than requested.";
+            return 0;
+        }
+        if (file.ranged && chunk.rangeTotal >= 0 && chunk.rangeTotal != file.totalBytes) {
+            file.failed = true;
+            file.error = "File changed size on the server during the download.";
+            return 0;
+        }
+        chunk.statusChecked = true;
+    }
+    if (chunk.end >= 0 && chunk.position + static_cast<long long>(total) > chunk.end) {
+        chunk.error = "Server sent more bytes than requested.";
+        return 0;
+    }
+
+    // Straight from curl's receive buffer to the sink, nothing of the file is held here
+    std::string error;
+    if (!file.sink->write(chunk.position, data, total, error)) {
+        // Retrying cannot fix a full or failing disk
+        file.failed = true;
+        file.error = std::move(error);
+        return 0;
+    }
+    chunk.position += static_cast<long long>(total);
+    file.written += static_cast<long long>(total);
+    return total;
+}
+
+void DownloadEngine::onChunkDone(const std::shared_ptr<ChunkTransfer>& chunk, CURLcode result) {
+    FileTransfer& file = *chunk->file;
+    long httpCode = 0;
+    curl_easy_getinfo(chunk->handle.get(), CURLINFO_RESPONSE_CODE, &httpCode);
+    chunk->handle.reset();
+    --file.inFlight;
+
+    long expected = file.ranged ? 206 : 200;
+    bool complete = result == CURLE_OK && httpCode == expected && (chunk->end < 0 || chunk->position == chunk->end);
+    if (complete) {
+        if (chunk->end < 0) file.totalBytes = chunk->position;
+        journalChunk(*chunk);
+        reportProgress(file, false);
+        startChunks(chunk->file);
+        finishIfDone(chunk->file);
+        return;
+    }
+
+    if (!file.failed) {
+        std::string message = chunk->error;
+        if (message.empty() && result != CURLE_OK) message = curl_easy_strerror(result);
+        if (message.empty() && httpCode != expected) {
+            message = "HTTP request failed with status " + std::to_string(httpCode) + ".";
+        }
+        if (message.empty()) message = "Transfer ended before the range was complete.";
+
+        // Aborted means the engine is shutting down, nothing would run the retry
+        bool retry = chunk->attempt < options.maxChunkAttempts && result != CURLE_ABORTED_BY_CALLBACK
+            && result != CURLE_FAILED_INIT;
+        if (retry) {
+            // Without ranges the stream has to start over
+            if (!file.ranged) {
+                file.written -= chunk->position;
+                chunk->position = 0;
+            }
+            submitChunk(chunk, std::chrono::steady_clock::now() + RetryBackoff * chunk->attempt);
+            if (chunk->handle) return;
+        } else {
+            failFile(file, message);
+        }
+    }
+    // Whatever arrived before the failure is kept for the next attempt at the file
+    journalChunk(*chunk);
+    finishIfDone(chunk->file);
+}
+
+void DownloadEngine::journalChunk(ChunkTransfer& chunk) {
+    FileTransfer& file = *chunk.file;
+    if (!file.journal.isOpen() || chunk.position <= chunk.start) return;
+    // Journaled bytes have to be on disk, or a power loss leaves holes the journal claims are filled
+    std::string error;
+    if (options.syncJournal && !file.sink->sync(error)) {
+        file.journal.close();
+        return;
+    }
+    file.journal.record(chunk.start, chunk.position);
+    chunk.start = chunk.position;
+}
+
+void DownloadEngine::failFile(FileTransfer& file, const std::string& message) {
+    if (file.failed) return;
+    file.failed = true;
+    file.error = message;
+}
+
+void DownloadEngine::reportProgress(FileTransfer& file, bool final) {
+    if (!options.onProgress) return;
+    auto now = std::chrono::steady_clock::now();
+    if (!final && now - file.lastProgress < options.progressInterval) return;
+    file.lastProgress = now;
+
+    DownloadProgress progress;
+    progress.job = file.job;
+    progress.downloadId = file.request.downloadId;
+    progress.bytes = file.written;
+    progress.totalBytes = file.totalBytes;
+    // Runs on the engine thread, an exception would end up inside curl
+    try {
+        options.onProgress(progress);
+    } catch (...) {
+    }
+}
+
+void DownloadEngine::finishIfDone(const std::shared_ptr<FileTransfer>& file) {
+    if (file->finished || file->inFlight > 0) return;
+    file->finished = true;
+
+    if (file->sinkOpen) {
+        std::string error;
+        if (!file->sink->close(!file->failed, error)) failFile(*file, error);
+        if (!file->failed && !file->request.sink) ::unlink((file->path + ".journal").c_str());
+        file->journal.close();
+        file->sink.reset();
+    }
+    if (!file->failed) reportProgress(*file, true);
+
+    DownloadResult result;
+    result.url = file->request.url;
+    result.downloadId = file->request.downloadId;
+    result.path = file->path;
+    result.bytes = file->written;
+    result.resumedBytes = file->resumedBytes;
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - file->started);
+    result.success = !file->failed;
+    if (file->failed) {
+        result.errorData.errorCode = -1;
+        result.errorData.errorMessage = file->error;
+    }
+
+    Batch& batch = *file->batch;
+    if (batch.onDone) {
+        // Runs on the engine thread, an exception would end up inside curl
+        try {
+            batch.onDone(std::move(result));
+        } catch (...) {
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        batch.results[file->job] = std::move(result);
+        --batch.remaining;
+    }
+    batch.done.notify_all();
+}
@@ -0,0 +1,151 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the download progress journal
+
+#include "usgsm2m_journal.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+constexpr const char* JournalMagic = "usgsm2m-download 1 ";
+
+bool writeAll(int fd, const std::string& text) {
+    const char* data = text.data();
+    size_t size = text.size();
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string readAll(int fd) {
+    std::string text;
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        text.append(buffer, static_cast<size_t>(n));
+    }
+    return text;
+}
+
+/// @brief Parse "<begin> <end>" into a range within [0, totalBytes)
+bool parseRange(const std::string& line, long long totalBytes, long long& begin, long long& end) {
+    const char* text = line.c_str();
+    char* next = nullptr;
+    errno = 0;
+    begin = std::strtoll(text, &next, 10);
+    if (next == text || *next != ' ') return false;
+    text = next + 1;
+    end = std::strtoll(text, &next, 10);
+    if (next == text || *next != '\0' || errno != 0) return false;
+    return begin >= 0 && begin < end && end <= totalBytes;
+}
+
+} // namespace
+
+/**********************************  DownloadJournal ***********************************************/
+
+DownloadJournal::~DownloadJournal() {
+    close();
+}
+
+bool DownloadJournal::open(const std::string& path, long long totalBytes, const std::string& validator,
+    bool resume) {
+
+    close();
+    ranges.clear();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    std::string header = JournalMagic + std::to_string(totalBytes) + " " + validator + "\n";
+    std::string text = resume ? readAll(fd) : std::string();
+    size_t kept = 0;
+    if (text.compare(0, header.size(), header) == 0) {
+        kept = header.size();
+        size_t lineEnd;
+        while ((lineEnd = text.find('\n', kept)) != std::string::npos) {
+            long long begin, end;
+            if (!parseRange(text.substr(kept, lineEnd - kept), totalBytes, begin, end)) break;
+            merge(begin, end);
+            kept = lineEnd + 1;
+        }
+    }
+
+    // Another file, no journal yet or a torn last line: cut back to what is known to be good
+    if (kept == 0) {
+        if (::ftruncate(fd, 0) != 0 || ::lseek(fd, 0, SEEK_SET) != 0 || !writeAll(fd, header)) {
+            close();
+            return false;
+        }
+    } else if (kept != text.size()) {
+        if (::ftruncate(fd, static_cast<off_t>(kept)) != 0) {
+            close();
+            ranges.clear();
+            return false;
+        }
+    }
+    ::lseek(fd, 0, SEEK_END);
+    return true;
+}
+
+void DownloadJournal::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+void DownloadJournal::record(long long begin, long long end) {
+    if (fd < 0 || begin >= end) return;
+    if (!writeAll(fd, std::to_string(begin) + " " + std::to_string(end) + "\n")) {
+        // A partial line is dropped on the next open, the ranges before it stay valid
+        close();
+        return;
+    }
+    merge(begin, end);
+}
+
+long long DownloadJournal::completedBytes() const {
+    long long total = 0;
+    for (const auto& range : ranges) total += range.second - range.first;
+    return total;
+}
+
+long long DownloadJournal::nextMissing(long long offset) const {
+    for (const auto& range : ranges) {
+        if (range.first > offset) break;
+        if (range.second > offset) return range.second;
+    }
+    return offset;
+}
+
+long long DownloadJournal::nextCompleted(long long offset) const {
+    for (const auto& range : ranges) {
+        if (range.first > offset) return range.first;
+    }
+    return std::numeric_limits<long long>::max();
+}
+
+void DownloadJournal::merge(long long begin, long long end) {
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), std::make_pair(begin, end));
+    it = ranges.insert(it, {begin, end});
+    if (it != ranges.begin() && std::prev(it)->second >= it->first) {
+        --it;
+        it->second = std::max(it->second, std::next(it)->second);
+        ranges.erase(std::next(it));
+    }
+    while (std::next(it) != ranges.end() && std::next(it)->first <= it->second) {
+        it->second = std::max(it->second, std::next(it)->second);
+        ranges.erase(std::next(it));
+    }
+}
@@ -5,20 +5,14 @@
 #include "usgsm2m.hpp"
 
 DefaultResponse USGS_M2M_API::loginAppGuest(const std::string& applicationToken, const std::string& userToken) {
-    DefaultResponse result;
-
     // Prepare JSON payload
     nlohmann::json requestJson;
     requestJson["applicationToken"] = applicationToken;
     requestJson["userToken"] = userToken;
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "login-app-guest", result.data, jsonPayload);
+    return defaultJsonResponseParsing("login-app-guest", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::loginToken(const std::string& username, const std::string& token, const UserContext& context) {
-    DefaultResponse result;
-
     // Prepare JSON payload
     nlohmann::json requestJson;
     requestJson["username"] = username;
@@ -32,9 +26,7 @@ DefaultResponse USGS_M2M_API::loginToken(const std::string& username, const std:
         };
     }
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "login-token", result.data, jsonPayload);
+    return defaultJsonResponseParsing("login-token", requestJson);
 }
 
 DefaultResponse USGS_M2M_API::loginSSO(const UserContext& context) {
@@ -51,9 +43,7 @@ DefaultResponse USGS_M2M_API::loginSSO(const UserContext& context) {
         };
     }
 
-    std::string jsonPayload = requestJson.dump();
-
-    return defaultJsonResponseParsing(API_URL + "login-sso", result.data, jsonPayload);;
+    return defaultJsonResponseParsing("login-sso", requestJson);;
 }
 
 LogoutResponse USGS_M2M_API::logout() {
@@ -62,7 +52,11 @@ LogoutResponse USGS_M2M_API::logout() {
     // Call HTTP POST helper
     std::string responseBody;
     long httpCode = 0;
-    result.success = performJsonGetRequest(API_URL + "logout", responseBody, httpCode);
+    if (!waitForSendSlot(0, RequestDeadline::current())) {
+        result.errorData = deadlineExceeded();
+        return result;
+    }
+    result.success = performJsonGetRequest(endpointUrl("logout"), responseBody, httpCode);
     
     httpRequestSuccessful(httpCode, result.success, result.errorData);
 
@@ -0,0 +1,188 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the USGS M2M API client request metrics
+
+#include "usgsm2m_metrics.hpp"
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
+/**********************************  LatencyHistogram ***********************************************/
+
+size_t LatencyHistogram::bucketIndex(uint64_t micros) {
+    if (micros < SubBuckets) return static_cast<size_t>(micros);
+    if (micros >> MaxBits) return BucketCount - 1;
+
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(micros));
+    unsigned shift = msb - SubBucketBits;
+    return static_cast<size_t>((shift + 1) * SubBuckets + ((micros >> shift) - SubBuckets));
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t index) {
+    if (index < SubBuckets) return index;
+    uint64_t shift = index / SubBuckets - 1;
+    return (SubBuckets + index % SubBuckets) << shift;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(micros, std::memory_order_relaxed);
+}
+
+std::chrono::microseconds LatencyHistogramSnapshot::percentile(double fraction) const {
+    if (count == 0) return std::chrono::microseconds{0};
+
+    uint64_t rank = static_cast<uint64_t>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (const auto& [upperBound, bucketCount] : buckets) {
+        seen += bucketCount;
+        if (seen > rank || seen == count) return std::chrono::microseconds(static_cast<int64_t>(upperBound));
+    }
+    return std::chrono::microseconds(static_cast<int64_t>(buckets.back().first));
+}
+
+uint64_t LatencyHistogramSnapshot::countBelow(uint64_t micros) const {
+    uint64_t below = 0;
+    for (const auto& [upperBound, bucketCount] : buckets) {
+        if (upperBound > micros) break;
+        below += bucketCount;
+    }
+    return below;
+}
+
+/**********************************  MetricsRegistry ***********************************************/
+
+MetricsRegistry::~MetricsRegistry() {
+    for (auto& slot : slots) delete slot.load();
+}
+
+MetricsRegistry::Endpoint* MetricsRegistry::find(const std::string& endpoint) {
+    size_t start = std::hash<std::string>{}(endpoint) % MaxEndpoints;
+    std::unique_ptr<Endpoint> claim;
+
+    for (size_t probe = 0; probe < MaxEndpoints; ++probe) {
+        std::atomic<Endpoint*>& slot = slots[(start + probe) % MaxEndpoints];
+        Endpoint* current = slot.load(std::memory_order_acquire);
+        if (!current) {
+            if (!claim) claim = std::make_unique<Endpoint>(endpoint);
+            if (slot.compare_exchange_strong(current, claim.get(), std::memory_order_acq_rel)) {
+                return claim.release();
+            }
+            // Lost the race, current now holds the winner which may be this endpoint
+        }
+        if (current->name == endpoint) return current;
+    }
+    return nullptr;
+}
+
+void MetricsRegistry::countError(Endpoint& metrics, int code) {
+    for (ErrorSlot& slot : metrics.errors) {
+        int64_t current = slot.code.load(std::memory_order_acquire);
+        if (current == EmptyCode) {
+            slot.code.compare_exchange_strong(current, code, std::memory_order_acq_rel);
+            // current is now either our code or the one that won the slot
+            if (current == EmptyCode) current = code;
+        }
+        if (current == code) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (code != -1) countError(metrics, -1);
+}
+
+void MetricsRegistry::record(const std::string& endpoint, std::chrono::microseconds latency, uint64_t bytesSent,
+    uint64_t bytesReceived, bool success, const std::optional<int>& errorCode) {
+
+    Endpoint* metrics = find(endpoint);
+    if (!metrics) return;
+
+    metrics->requests.fetch_add(1, std::memory_order_relaxed);
+    metrics->bytesSent.fetch_add(bytesSent, std::memory_order_relaxed);
+    metrics->bytesReceived.fetch_add(bytesReceived, std::memory_order_relaxed);
+    metrics->latency.record(static_cast<uint64_t>(std::max<int64_t>(0, latency.count())));
+    if (!success) {
+        metrics->failures.fetch_add(1, std::memory_order_relaxed);
+        countError(*metrics, errorCode.value_or(-1));
+    }
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot snapshot;
+    for (const auto& slot : slots) {
+        const Endpoint* metrics = slot.load(std::memory_order_acquire);
+        if (!metrics) continue;
+
+        EndpointMetricsSnapshot endpoint;
+        endpoint.endpoint = metrics->name;
+        endpoint.requests = metrics->requests.load(std::memory_order_relaxed);
+        endpoint.failures = metrics->failures.load(std::memory_order_relaxed);
+        endpoint.bytesSent = metrics->bytesSent.load(std::memory_order_relaxed);
+        endpoint.bytesReceived = metrics->bytesReceived.load(std::memory_order_relaxed);
+
+        for (const ErrorSlot& error : metrics->errors) {
+            int64_t code = error.code.load(std::memory_order_acquire);
+            uint64_t count = error.count.load(std::memory_order_relaxed);
+            if (code != EmptyCode && count) endpoint.errorCodes[static_cast<int>(code)] += count;
+        }
+
+        for (size_t i = 0; i < LatencyHistogram::BucketCount; ++i) {
+            uint64_t count = metrics->latency.bucketCount(i);
+            if (!count) continue;
+            uint64_t upperBound = i + 1 < LatencyHistogram::BucketCount
+                ? LatencyHistogram::bucketLowerBound(i + 1) : UINT64_MAX;
+            endpoint.latency.buckets.emplace_back(upperBound, count);
+            endpoint.latency.count += count;
+        }
+        endpoint.latency.sumMicros = metrics->latency.sum();
+
+        snapshot.endpoints.push_back(std::move(endpoint));
+    }
+
+    std::sort(snapshot.endpoints.begin(), snapshot.endpoints.end(),
+        [](const EndpointMetricsSnapshot& a, const EndpointMetricsSnapshot& b) { return a.endpoint < b.endpoint; });
+    return snapshot;
+}
+
+/**********************************  Prometheus export ***********************************************/
+
+std::string MetricsSnapshot::prometheusText(const std::string& prefix) const {
+    std::ostringstream out;
+    out.precision(12);
+
+    auto counter = [&](const std::string& name, const char* help, uint64_t EndpointMetricsSnapshot::*field) {
+        out << "# HELP " << prefix << name << " " << help << "\n";
+        out << "# TYPE " << prefix << name << " counter\n";
+        for (const auto& endpoint : endpoints) {
+            out << prefix << name << "{endpoint=\"" << endpoint.endpoint << "\"} " << endpoint.*field << "\n";
+        }
+    };
+    counter("_requests_total", "Requests sent per endpoint.", &EndpointMetricsSnapshot::requests);
+    counter("_request_failures_total", "Failed requests per endpoint.", &EndpointMetricsSnapshot::failures);
+    counter("_bytes_sent_total", "Request body bytes sent per endpoint.", &EndpointMetricsSnapshot::bytesSent);
+    counter("_bytes_received_total", "Response body bytes received per endpoint.", &EndpointMetricsSnapshot::bytesReceived);
+
+    out << "# HELP " << prefix << "_errors_total Failed requests per endpoint and error code.\n";
+    out << "# TYPE " << prefix << "_errors_total counter\n";
+    for (const auto& endpoint : endpoints) {
+        for (const auto& [code, count] : endpoint.errorCodes) {
+            out << prefix << "_errors_total{endpoint=\"" << endpoint.endpoint << "\",code=\"" << code << "\"} " << count << "\n";
+        }
+    }
+
+    // Powers of two are bucket boundaries of the log-linear histogram, so these counts are exact
+    out << "# HELP " << prefix << "_request_duration_seconds Request latency including JSON encode and decode.\n";
+    out << "# TYPE " << prefix << "_request_duration_seconds histogram\n";
+    for (const auto& endpoint : endpoints) {
+        std::string labels = "endpoint=\"" + endpoint.endpoint + "\"";
+        for (unsigned bits = 7; bits <= 26; ++bits) {
+            uint64_t bound = uint64_t{1} << bits;
+            out << prefix << "_request_duration_seconds_bucket{" << labels << ",le=\"" << bound / 1e6 << "\"} "
+                << endpoint.latency.countBelow(bound) << "\n";
+        }
+        out << prefix << "_request_duration_seconds_bucket{" << labels << ",le=\"+Inf\"} " << endpoint.latency.count << "\n";
+        out << prefix << "_request_duration_seconds_sum{" << labels << "} " << endpoint.latency.sumMicros / 1e6 << "\n";
+        out << prefix << "_request_duration_seconds_count{" << labels << "} " << endpoint.latency.count << "\n";
+    }
+    return out.str();
+}
@@ -25,9 +25,7 @@ DefaultResponse USGS_M2M_API::grid2ll(
     if (path) payload["path"] = *path;
     if (row) payload["row"] = *row;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "grid2ll", result.data, jsonPayload);
+    return defaultJsonResponseParsing("grid2ll", payload);
 }
 
 DefaultResponse USGS_M2M_API::notifications(const std::string& systemId) {
@@ -43,9 +41,7 @@ DefaultResponse USGS_M2M_API::notifications(const std::string& systemId) {
     nlohmann::json payload;
     payload["systemId"] = systemId;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "notifications", result.data, jsonPayload);
+    return defaultJsonResponseParsing("notifications", payload);
 }
 
 DefaultResponse USGS_M2M_API::orderProducts(
@@ -68,9 +64,7 @@ DefaultResponse USGS_M2M_API::orderProducts(
     if (entityIds) payload["entityIds"] = *entityIds;
     if (listId) payload["listId"] = *listId;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "order-products", result.data, jsonPayload);
+    return defaultJsonResponseParsing("order-products", payload);
 }
 
 DefaultResponse USGS_M2M_API::orderSubmit(
@@ -117,57 +111,45 @@ DefaultResponse USGS_M2M_API::orderSubmit(
     if (orderComment) payload["orderComment"] = *orderComment;
     if (systemId) payload["systemId"] = *systemId;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "order-submit", result.data, jsonPayload);
+    return defaultJsonResponseParsing("order-submit", payload);
 }
 
 DefaultResponse USGS_M2M_API::permissions() {
-    DefaultResponse result;
-    return defaultJsonResponseParsing(API_URL + "permissions", result.data);
+    return defaultJsonResponseParsing("permissions");
 }
 
 DefaultResponse USGS_M2M_API::placename(
     const std::optional<std::string>& featureType,
     const std::optional<std::string>& name
 ) {
-    DefaultResponse result;
     nlohmann::json payload;
 
     if (featureType) payload["featureType"] = *featureType;
     if (name) payload["name"] = *name;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "placename", result.data, jsonPayload);
+    return defaultJsonResponseParsing("placename", payload);
 }
 
 DefaultResponse USGS_M2M_API::rateLimitSummary(
     const std::optional<std::vector<std::string>>& ipAddress
 ) {
-    DefaultResponse result;
     nlohmann::json payload;
 
     if (ipAddress) payload["ipAddress"] = *ipAddress;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "rate-limit-summary", result.data, jsonPayload);
+    return defaultJsonResponseParsing("rate-limit-summary", payload);
 }
 
 DefaultResponse USGS_M2M_API::userPreferenceGet(
     const std::optional<std::string>& systemId,
     const std::optional<std::vector<std::string>>& setting
 ) {
-    DefaultResponse result;
     nlohmann::json payload;
 
     if (systemId) payload["systemId"] = *systemId;
     if (setting) payload["setting"] = *setting;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "user-preference-get", result.data, jsonPayload);
+    return defaultJsonResponseParsing("user-preference-get", payload);
 }
 
 DefaultResponse USGS_M2M_API::userPreferenceSet(
@@ -194,7 +176,5 @@ DefaultResponse USGS_M2M_API::userPreferenceSet(
     payload["systemId"] = systemId;
     payload["userPreferences"] = userPreferences;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "user-preference-set", result.data, jsonPayload);
+    return defaultJsonResponseParsing("user-preference-set", payload);
 }
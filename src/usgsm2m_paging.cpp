@@ -0,0 +1,146 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the USGS M2M API C++ paging helpers for scene searches
+
+#include "usgsm2m.hpp"
+
+DefaultResponse USGS_M2M_API::sceneSearchPage(
+    const std::string& datasetName,
+    int maxResults,
+    int startingNumber,
+    const SceneSearchOptions& options
+) {
+    return sceneSearch(datasetName, maxResults, startingNumber,
+        options.metadataType, options.sortField, options.sortDirection, options.sortCustomization,
+        options.useCustomization, options.sceneFilter, options.compareListName, options.bulkListName,
+        options.orderListName, options.excludeListName, options.includeNullMetadataValues);
+}
+
+SceneSearchPager USGS_M2M_API::sceneSearchPages(
+    const std::string& datasetName,
+    int pageSize,
+    const SceneSearchOptions& options,
+    bool prefetch
+) {
+    return SceneSearchPager(*this, datasetName, pageSize, options, prefetch);
+}
+
+DefaultResponse USGS_M2M_API::sceneSearchParallel(
+    const std::string& datasetName,
+    int pageSize,
+    const SceneSearchOptions& options,
+    size_t maxConcurrentPages
+) {
+    if (pageSize <= 0) pageSize = 100;
+    if (maxConcurrentPages == 0) maxConcurrentPages = 1;
+
+    DefaultResponse result = sceneSearchPage(datasetName, pageSize, 1, options);
+    if (!result.success) return result;
+
+    nlohmann::json& data = result.data;
+    if (!data.contains("results") || !data["results"].is_array()) return result;
+    nlohmann::json& results = data["results"];
+
+    int totalHits = safeGetIntOpt(data, "totalHits").value_or(0);
+    int firstPageSize = static_cast<int>(results.size());
+    if (firstPageSize == 0 || firstPageSize >= totalHits) return result;
+
+    // Step by what the server actually returned in case it caps maxResults below pageSize
+    std::vector<int> starts;
+    for (int start = 1 + firstPageSize; start <= totalHits; start += firstPageSize) {
+        starts.push_back(start);
+    }
+
+    std::vector<std::future<DefaultResponse>> pages(starts.size());
+    size_t submitted = 0;
+    auto submitUpTo = [&](size_t limit) {
+        for (; submitted < limit && submitted < starts.size(); ++submitted) {
+            int start = starts[submitted];
+            pages[submitted] = submitAsync([&, start](USGS_M2M_API& client) {
+                return client.sceneSearchPage(datasetName, firstPageSize, start, options);
+            });
+        }
+    };
+
+    // Sliding window: collect pages in order, keeping maxConcurrentPages in flight
+    for (size_t i = 0; i < pages.size(); ++i) {
+        submitUpTo(i + maxConcurrentPages);
+
+        DefaultResponse page = pages[i].get();
+        if (!page.success) return page;
+        if (page.data.contains("results") && page.data["results"].is_array()) {
+            for (auto& scene : page.data["results"]) results.push_back(std::move(scene));
+        }
+    }
+
+    data["recordsReturned"] = results.size();
+    data["nextRecord"] = 1 + static_cast<int>(results.size());
+    return result;
+}
+
+/**********************************  SceneSearchPager ***********************************************/
+
+SceneSearchPager::SceneSearchPager(USGS_M2M_API& api, std::string datasetName, int pageSize,
+    SceneSearchOptions options, bool prefetch)
+    : api(api), datasetName(std::move(datasetName)), pageSize(pageSize > 0 ? pageSize : 100),
+      options(std::move(options)), prefetch(prefetch) {}
+
+SceneSearchPager::iterator SceneSearchPager::begin() {
+    if (!loadNextPage()) return end();
+    return iterator(this);
+}
+
+bool SceneSearchPager::advance() {
+    if (++index < results.size()) return true;
+    return loadNextPage();
+}
+
+bool SceneSearchPager::loadNextPage() {
+    if (!nextStart) return false;
+    int start = *nextStart;
+
+    DefaultResponse page;
+    if (pendingPage) {
+        page = pendingPage->get();
+        pendingPage.reset();
+    } else {
+        page = api.sceneSearchPage(datasetName, pageSize, start, options);
+    }
+
+    if (!page.success) {
+        ok = false;
+        errorData = page.errorData;
+        nextStart.reset();
+        return false;
+    }
+
+    // Drop the previous page before holding on to the new one
+    results = nlohmann::json::array();
+    index = 0;
+    if (page.data.contains("results") && page.data["results"].is_array()) {
+        results = std::move(page.data["results"]);
+    }
+    if (!hits && page.data.contains("totalHits") && page.data["totalHits"].is_number_integer()) {
+        hits = page.data["totalHits"].get<int>();
+    }
+
+    // totalHits is authoritative, a short page only ends the search when it is unknown
+    int next = start + static_cast<int>(results.size());
+    bool lastPage = results.empty() || (hits ? next > *hits : static_cast<int>(results.size()) < pageSize);
+    if (lastPage) {
+        nextStart.reset();
+    } else {
+        nextStart = next;
+        if (prefetch) prefetchNextPage();
+    }
+
+    return !results.empty();
+}
+
+void SceneSearchPager::prefetchNextPage() {
+    int start = *nextStart;
+    // The lambda only runs inside submitAsync, capturing this is safe
+    pendingPage = api.submitAsync([this, start](USGS_M2M_API& client) {
+        return client.sceneSearchPage(datasetName, pageSize, start, options);
+    });
+}
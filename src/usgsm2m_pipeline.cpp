@@ -0,0 +1,357 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the download pipeline
+
+#include "usgsm2m_pipeline.hpp"
+#include <algorithm>
+
+namespace {
+
+long long entryDownloadId(const nlohmann::json& entry) {
+    auto id = entry.find("downloadId");
+    if (id == entry.end() || !id->is_number_integer()) return 0;
+    return id->get<long long>();
+}
+
+std::string entryString(const nlohmann::json& entry, const char* key) {
+    auto value = entry.find(key);
+    if (value == entry.end() || !value->is_string()) return std::string();
+    return value->get<std::string>();
+}
+
+const nlohmann::json& entryArray(const nlohmann::json& data, const char* key) {
+    static const nlohmann::json empty = nlohmann::json::array();
+    if (!data.is_object()) return empty;
+    auto list = data.find(key);
+    return list != data.end() && list->is_array() ? *list : empty;
+}
+
+} // namespace
+
+/**********************************  DownloadPipeline ***********************************************/
+
+DownloadPipeline::DownloadPipeline(USGS_M2M_API& client, const DownloadPipelineOptions& pipelineOptions)
+    : api(client), options(pipelineOptions), engine(pipelineOptions.download) {
+    options.requestBatchSize = std::max<size_t>(options.requestBatchSize, 1);
+    options.maxConcurrentRequests = std::max<size_t>(options.maxConcurrentRequests, 1);
+    options.maxConcurrentFiles = std::max<size_t>(options.maxConcurrentFiles, 1);
+    // A zero interval would poll download-retrieve in a tight loop while anything is preparing
+    options.minPollInterval = std::max<std::chrono::milliseconds>(options.minPollInterval, std::chrono::seconds(1));
+    options.maxPollInterval = std::max(options.maxPollInterval, options.minPollInterval);
+    options.pollBackoff = std::max(options.pollBackoff, 1.0);
+    if (!options.directory.empty() && options.directory.back() != '/') options.directory += '/';
+}
+
+std::vector<DownloadPipelineResult> DownloadPipeline::run(const std::vector<Download>& downloads) {
+    runLabel = options.label;
+    if (runLabel.empty()) {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        runLabel = "usgsm2m-" + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+    }
+    items.clear();
+    byDownloadId.clear();
+    unmatched.clear();
+    anonymousEntries = false;
+    availableQueue.clear();
+    proxiedPending.clear();
+    progress = DownloadPipelineProgress();
+    progress.requested = downloads.size();
+    progressChanged = true;
+    requestsInFlight = 0;
+    fetchesInFlight = 0;
+    pollInterval = options.minPollInterval;
+    progress.pollInterval = pollInterval;
+    polledSinceRequests = true;
+
+    size_t batches = (downloads.size() + options.requestBatchSize - 1) / options.requestBatchSize;
+    size_t nextBatch = 0;
+
+    // The event loops report into this object, they must be done with it before an exception leaves run
+    try {
+        for (;;) {
+            while (requestsInFlight < options.maxConcurrentRequests && nextBatch < batches) {
+                submitBatch(downloads, nextBatch++);
+            }
+            startFetches();
+            if (!proxiedPending.empty() && (fetchesInFlight == 0 || proxiedPending.size() >= options.requestBatchSize)) {
+                reportProxied();
+            }
+
+            bool requestsDone = nextBatch == batches && requestsInFlight == 0;
+            bool preparing = progress.preparing > 0;
+            // Downloads of an entity may already exist under the label, one poll after the requests finds them
+            bool adoptPoll = requestsDone && !unmatched.empty() && !polledSinceRequests;
+            auto now = std::chrono::steady_clock::now();
+            if (adoptPoll || (preparing && now >= nextPoll)) {
+                poll();
+                continue;
+            }
+            reportProgress();
+
+            bool busy = !requestsDone || preparing || progress.available > 0 || fetchesInFlight > 0
+                || !proxiedPending.empty();
+            if (!busy) break;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (preparing) {
+                wake.wait_until(lock, nextPoll, [this]() { return !events.empty(); });
+            } else {
+                wake.wait(lock, [this]() { return !events.empty(); });
+            }
+            std::vector<Event> ready;
+            ready.swap(events);
+            lock.unlock();
+
+            for (const Event& event : ready) --(event.isFetch ? fetchesInFlight : requestsInFlight);
+            for (Event& event : ready) {
+                if (event.isFetch) {
+                    Item& item = items[event.item];
+                    item.result.file = std::move(event.file);
+                    if (item.result.file.success) {
+                        item.result.success = true;
+                        setStage(item, DownloadStage::Completed);
+                        if (options.completeProxied) proxiedPending.push_back(event.item);
+                    } else {
+                        failItem(item, item.result.file.errorData.errorMessage);
+                    }
+                } else {
+                    onBatchDone(downloads, event.batch, event.response);
+                }
+            }
+        }
+    } catch (...) {
+        drain();
+        throw;
+    }
+
+    std::vector<DownloadPipelineResult> results;
+    results.reserve(items.size() + unmatched.size());
+    for (Item& item : items) results.push_back(std::move(item.result));
+    // Without entity IDs in the responses an entity may have been served by one of the anonymous downloads
+    const char* unmatchedMessage = anonymousEntries
+        ? "No download was confirmed for this entity, the server returned downloads without entity IDs."
+        : "download-request returned no download for this entity.";
+    for (const std::string& entityId : unmatched) {
+        DownloadPipelineResult result;
+        result.entityId = entityId;
+        result.stage = DownloadStage::Failed;
+        result.errorData.errorCode = -1;
+        result.errorData.errorMessage = unmatchedMessage;
+        results.push_back(std::move(result));
+    }
+    items.clear();
+    byDownloadId.clear();
+    unmatched.clear();
+    return results;
+}
+
+void DownloadPipeline::submitBatch(const std::vector<Download>& downloads, size_t batch) {
+    size_t begin = batch * options.requestBatchSize;
+    size_t end = std::min(begin + options.requestBatchSize, downloads.size());
+    std::vector<Download> slice(downloads.begin() + begin, downloads.begin() + end);
+    for (const Download& download : slice) unmatched.insert(download.entityId);
+
+    api.submitAsync(
+        [this, slice = std::move(slice)](USGS_M2M_API& client) {
+            return client.downloadRequest(std::nullopt, options.downloadApplication, slice, std::nullopt, runLabel);
+        },
+        [this, batch](DefaultResponse response) {
+            Event event;
+            event.batch = batch;
+            event.response = std::move(response);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                events.push_back(std::move(event));
+            }
+            wake.notify_one();
+        });
+    ++requestsInFlight;
+}
+
+void DownloadPipeline::onBatchDone(const std::vector<Download>& downloads, size_t batch, DefaultResponse& response) {
+    size_t begin = batch * options.requestBatchSize;
+    size_t end = std::min(begin + options.requestBatchSize, downloads.size());
+    progress.requested -= end - begin;
+    progressChanged = true;
+    polledSinceRequests = false;
+
+    if (!response.success) {
+        // The whole batch is lost, every entity of it fails with the request's error
+        for (size_t i = begin; i < end; ++i) {
+            if (unmatched.erase(downloads[i].entityId) == 0) continue;
+            Item item;
+            item.result.entityId = downloads[i].entityId;
+            item.result.errorData = response.errorData;
+            item.result.stage = DownloadStage::Failed;
+            ++progress.failed;
+            items.push_back(std::move(item));
+        }
+        return;
+    }
+
+    for (const auto& entry : entryArray(response.data, "availableDownloads")) trackEntry(entry, true, false);
+    for (const auto& entry : entryArray(response.data, "preparingDownloads")) trackEntry(entry, false, false);
+}
+
+bool DownloadPipeline::trackEntry(const nlohmann::json& entry, bool available, bool adoptOnly) {
+    if (!entry.is_object()) return false;
+    long long downloadId = entryDownloadId(entry);
+    if (downloadId <= 0) return false;
+    std::string entityId = entryString(entry, "entityId");
+    std::string url = entryString(entry, "url");
+
+    auto known = byDownloadId.find(downloadId);
+    if (known == byDownloadId.end()) {
+        // download-retrieve lists every download of the label, only take those of this run's entities
+        if (adoptOnly && unmatched.count(entityId) == 0) return false;
+        if (entityId.empty()) anonymousEntries = true;
+        unmatched.erase(entityId);
+
+        Item item;
+        item.result.entityId = entityId;
+        item.result.downloadId = downloadId;
+        item.preparingSince = std::chrono::steady_clock::now();
+        known = byDownloadId.emplace(downloadId, items.size()).first;
+        items.push_back(std::move(item));
+        ++progress.requested;
+        setStage(items.back(), DownloadStage::Requested);
+    }
+
+    Item& item = items[known->second];
+    if (item.result.entityId.empty() && !entityId.empty()) {
+        item.result.entityId = entityId;
+        unmatched.erase(entityId);
+    }
+    DownloadStage stage = item.result.stage;
+    if (stage != DownloadStage::Requested && stage != DownloadStage::Preparing) return false;
+
+    // preparingDownloads carry a URL as well, it only works once the product is staged
+    if (available && !url.empty()) {
+        item.url = url;
+        setStage(item, DownloadStage::Available);
+        availableQueue.push_back(known->second);
+        return true;
+    }
+    if (stage == DownloadStage::Requested) {
+        if (progress.preparing == 0) {
+            pollInterval = options.minPollInterval;
+            progress.pollInterval = pollInterval;
+            nextPoll = std::chrono::steady_clock::now() + pollInterval;
+        }
+        setStage(item, DownloadStage::Preparing);
+    }
+    return false;
+}
+
+void DownloadPipeline::startFetches() {
+    while (fetchesInFlight < options.maxConcurrentFiles && !availableQueue.empty()) {
+        size_t index = availableQueue.front();
+        availableQueue.pop_front();
+        Item& item = items[index];
+        setStage(item, DownloadStage::Fetching);
+
+        DownloadJob job;
+        job.url = item.url;
+        job.path = options.directory;
+        job.downloadId = item.result.downloadId;
+        engine.fetchAsync(job, [this, index](DownloadResult&& file) {
+            Event event;
+            event.isFetch = true;
+            event.item = index;
+            event.file = std::move(file);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                events.push_back(std::move(event));
+            }
+            wake.notify_one();
+        });
+        ++fetchesInFlight;
+    }
+}
+
+void DownloadPipeline::poll() {
+    polledSinceRequests = true;
+    ++progress.polls;
+    progressChanged = true;
+
+    DefaultResponse response = api.downloadRetrieve(runLabel, options.downloadApplication);
+    bool madeProgress = false;
+    if (response.success) {
+        for (const auto& entry : entryArray(response.data, "available")) {
+            madeProgress |= trackEntry(entry, true, true);
+        }
+        for (const auto& entry : entryArray(response.data, "requested")) trackEntry(entry, false, true);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for (Item& item : items) {
+        if (item.result.stage == DownloadStage::Preparing && now - item.preparingSince > options.prepareTimeout) {
+            failItem(item, "Download was not available within the prepare timeout.");
+        }
+    }
+
+    // Staging finishes in waves, right after one product is ready the next often is too
+    if (madeProgress) {
+        pollInterval = options.minPollInterval;
+    } else {
+        auto grown = std::chrono::duration_cast<std::chrono::milliseconds>(pollInterval * options.pollBackoff);
+        pollInterval = std::min(grown, options.maxPollInterval);
+    }
+    progress.pollInterval = pollInterval;
+    nextPoll = now + pollInterval;
+}
+
+void DownloadPipeline::reportProxied() {
+    std::vector<ProxiedDownload> completed;
+    completed.reserve(proxiedPending.size());
+    for (size_t index : proxiedPending) {
+        const DownloadPipelineResult& result = items[index].result;
+        completed.push_back({static_cast<int>(result.downloadId), static_cast<size_t>(result.file.bytes)});
+    }
+    DefaultResponse response = api.downloadCompleteProxied(completed);
+    for (size_t index : proxiedPending) items[index].result.completeReported = response.success;
+    proxiedPending.clear();
+}
+
+void DownloadPipeline::setStage(Item& item, DownloadStage stage) {
+    auto counter = [this](DownloadStage of) -> size_t& {
+        switch (of) {
+        case DownloadStage::Requested: return progress.requested;
+        case DownloadStage::Preparing: return progress.preparing;
+        case DownloadStage::Available: return progress.available;
+        case DownloadStage::Fetching: return progress.fetching;
+        case DownloadStage::Completed: return progress.completed;
+        default: return progress.failed;
+        }
+    };
+    --counter(item.result.stage);
+    ++counter(stage);
+    item.result.stage = stage;
+    progressChanged = true;
+}
+
+void DownloadPipeline::failItem(Item& item, const std::string& message) {
+    item.result.success = false;
+    item.result.errorData.errorCode = -1;
+    item.result.errorData.errorMessage = message;
+    setStage(item, DownloadStage::Failed);
+}
+
+void DownloadPipeline::reportProgress() {
+    if (!progressChanged || !options.onProgress) return;
+    progressChanged = false;
+    // An exception would leave run with requests and transfers still reporting into the pipeline
+    try {
+        options.onProgress(progress);
+    } catch (...) {
+    }
+}
+
+void DownloadPipeline::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (requestsInFlight > 0 || fetchesInFlight > 0) {
+        wake.wait(lock, [this]() { return !events.empty(); });
+        for (const Event& event : events) --(event.isFetch ? fetchesInFlight : requestsInFlight);
+        events.clear();
+    }
+}
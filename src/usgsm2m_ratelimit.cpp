@@ -0,0 +1,249 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the client-side rate limiter and the rate limited request scheduling
+
+#include "usgsm2m.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+double secondsBetween(RateLimiter::Clock::time_point from, RateLimiter::Clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+RateLimiter::Clock::duration secondsToDuration(double seconds) {
+    return std::chrono::duration_cast<RateLimiter::Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+/// @brief Smallest recentDownloadCount of a limits entry, which may be one object or an array of them
+std::optional<double> recentDownloadCount(const nlohmann::json& limits) {
+    std::optional<double> smallest;
+    auto visit = [&](const nlohmann::json& entry) {
+        auto count = entry.find("recentDownloadCount");
+        if (count == entry.end() || !count->is_number()) return;
+        double value = count->get<double>();
+        smallest = smallest ? std::min(*smallest, value) : value;
+    };
+    if (limits.is_object()) visit(limits);
+    if (limits.is_array()) {
+        for (const auto& entry : limits) {
+            if (entry.is_object()) visit(entry);
+        }
+    }
+    return smallest;
+}
+
+} // namespace
+
+/**********************************  RateLimiter ***********************************************/
+
+void RateLimiter::configure(double ratePerSecond, double burstTokens, double available) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ratePerSecond <= 0) {
+        enabled = false;
+        return;
+    }
+    enabled = true;
+    rate = ceiling = configuredRate = ratePerSecond;
+    burst = std::max(1.0, burstTokens);
+    tokens = available < 0 ? burst : std::min(available, burst);
+    lastRefill = atCeilingSince = std::max(Clock::now(), pausedUntil);
+}
+
+void RateLimiter::refill(Clock::time_point now) {
+    if (now <= lastRefill) return;
+    tokens = std::min(burst, tokens + rate * secondsBetween(lastRefill, now));
+    lastRefill = now;
+}
+
+RateLimiter::Reservation RateLimiter::reserve(double cost) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Reservation reservation;
+    reservation.at = now;
+    reservation.generation = backoffs;
+    if (!enabled) return reservation;
+
+    refill(now);
+    tokens -= cost;
+    reservation.tokens = cost;
+    if (tokens >= 0) {
+        reservation.at = std::max(now, pausedUntil);
+    } else {
+        // In debt: wait until the refill has paid for this request
+        reservation.at = std::max(now, lastRefill) + secondsToDuration(-tokens / rate);
+    }
+    return reservation;
+}
+
+void RateLimiter::cancel(const Reservation& reservation) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled || reservation.tokens <= 0 || reservation.generation != backoffs) return;
+    refill(now);
+    tokens = std::min(burst, tokens + reservation.tokens);
+}
+
+bool RateLimiter::stale(const Reservation& reservation) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return reservation.tokens > 0 && reservation.generation != backoffs;
+}
+
+double RateLimiter::acceptedRateAt(Clock::time_point now) const {
+    return acceptedRate * std::exp(-secondsBetween(lastAccepted, now) / AcceptedRateWindow);
+}
+
+void RateLimiter::onSuccess() {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    acceptedRate = acceptedRateAt(now) + 1.0 / AcceptedRateWindow;
+    lastAccepted = now;
+
+    if (!enabled) return;
+    refill(now);
+    if (rate < ceiling) {
+        rate = std::min(ceiling, rate + ceiling * IncreaseFraction);
+        atCeilingSince = now;
+        return;
+    }
+
+    // At the ceiling without errors: probe upwards by ProbeFraction per second spent there, however
+    // many requests that took. A gap longer than one request interval is idle time and not counted.
+    double atCeiling = std::min(secondsBetween(atCeilingSince, now), std::max(1.0, 1.0 / rate));
+    ceiling *= std::pow(1.0 + ProbeFraction, std::max(0.0, atCeiling));
+    if (configuredRate > 0) ceiling = std::min(ceiling, configuredRate);
+    rate = ceiling;
+    atCeilingSince = now;
+}
+
+void RateLimiter::onLimited(std::chrono::seconds retryAfter) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    ++limitErrors;
+
+    // Requests already in flight were sent at the old rate, one back-off per pause is enough
+    if (now < pausedUntil) return;
+
+    ++backoffs;
+
+    // The server let through about acceptedRate requests per second before refusing one. A learned
+    // limit never goes below ColdStartRate, the refusal may be down to other clients sharing the quota.
+    double accepted = acceptedRateAt(now) * CeilingBackoff;
+    if (!enabled) {
+        enabled = true;
+        configuredRate = 0;
+        ceiling = rate = std::max(ColdStartRate, accepted);
+        burst = 1;
+    } else {
+        refill(now);
+        ceiling = std::min(ceiling, std::max(configuredRate > 0 ? MinRate : ColdStartRate, accepted));
+        rate = std::max(MinRate, std::min(rate, ceiling) * DecreaseFactor);
+    }
+
+    // Queued reservations were written off with the back-off, their requests reserve again
+    tokens = 0;
+    double pause = std::max(static_cast<double>(retryAfter.count()), 1.0 / rate);
+    pausedUntil = now + secondsToDuration(pause);
+    lastRefill = atCeilingSince = pausedUntil;
+}
+
+RateLimitState RateLimiter::state() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    RateLimitState current;
+    current.enabled = enabled;
+    current.rate = rate;
+    current.ceiling = ceiling;
+    current.burst = burst;
+    current.tokens = tokens;
+    current.limitErrors = limitErrors;
+
+    Clock::time_point now = Clock::now();
+    if (enabled && now > lastRefill) {
+        current.tokens = std::min(burst, tokens + rate * secondsBetween(lastRefill, now));
+    }
+    return current;
+}
+
+/**********************************  Rate Limit API Functions ***********************************************/
+
+void USGS_M2M_API::setRateLimit(double requestsPerSecond, double burst) {
+    requestLimiter.configure(requestsPerSecond, burst);
+}
+
+RateLimitState USGS_M2M_API::rateLimitState() const {
+    return requestLimiter.state();
+}
+
+RateLimitState USGS_M2M_API::downloadQuotaState() const {
+    return downloadLimiter.state();
+}
+
+DefaultResponse USGS_M2M_API::configureRateLimitFromSummary(std::chrono::seconds quotaWindow) {
+    DefaultResponse summary = rateLimitSummary();
+    if (!summary.success) return summary;
+
+    std::optional<double> limit, remaining;
+    if (summary.data.is_object()) {
+        if (auto it = summary.data.find("initialLimits"); it != summary.data.end()) limit = recentDownloadCount(*it);
+        if (auto it = summary.data.find("remainingLimits"); it != summary.data.end()) remaining = recentDownloadCount(*it);
+    }
+    if (!limit || *limit <= 0 || quotaWindow.count() <= 0) {
+        summary.success = false;
+        summary.errorData.errorCode = -1;
+        summary.errorData.errorMessage = "rateLimitSummary did not report a recentDownloadCount limit.";
+        return summary;
+    }
+
+    // The quota refills over the window, the remaining count is what may be spent right away
+    downloadLimiter.configure(*limit / static_cast<double>(quotaWindow.count()), *limit,
+        std::max(0.0, remaining.value_or(*limit)));
+    return summary;
+}
+
+USGS_M2M_API::SendSlot USGS_M2M_API::reserveSendSlot(size_t downloadCount) {
+    SendSlot slot;
+    slot.request = requestLimiter.reserve();
+    slot.at = slot.request.at;
+    if (downloadCount) {
+        slot.downloads = downloadLimiter.reserve(static_cast<double>(downloadCount));
+        slot.at = std::max(slot.at, slot.downloads.at);
+    }
+    return slot;
+}
+
+void USGS_M2M_API::cancelSendSlot(const SendSlot& slot) {
+    requestLimiter.cancel(slot.request);
+    downloadLimiter.cancel(slot.downloads);
+}
+
+bool USGS_M2M_API::sendSlotStale(const SendSlot& slot) const {
+    return requestLimiter.stale(slot.request) || downloadLimiter.stale(slot.downloads);
+}
+
+bool USGS_M2M_API::waitForSendSlot(size_t downloadCount, std::optional<RequestDeadline::Clock::time_point> deadline) {
+    for (;;) {
+        if (deadline && RateLimiter::Clock::now() >= *deadline) return false;
+        SendSlot slot = reserveSendSlot(downloadCount);
+        if (deadline && slot.at >= *deadline) {
+            // The tokens would otherwise stay taken and delay every later request
+            cancelSendSlot(slot);
+            return false;
+        }
+        if (slot.at > RateLimiter::Clock::now()) std::this_thread::sleep_until(slot.at);
+        if (!sendSlotStale(slot)) return true;
+        cancelSendSlot(slot);
+    }
+}
+
+void USGS_M2M_API::observeRateLimit(long httpCode, const ErrorResponse& errorData, const RequestTiming& timing) {
+    bool limited = httpCode == 429
+        || (errorData.errorCodeName && errorData.errorCodeName->rfind("RATE_LIMIT", 0) == 0);
+    if (limited) {
+        requestLimiter.onLimited(timing.retryAfter);
+    } else if (httpCode == 200) {
+        requestLimiter.onSuccess();
+    }
+}
@@ -0,0 +1,119 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the retry policy, the retry budget and the client's retry decisions
+
+#include "usgsm2m.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+/// @brief curl failures after which the server cannot have seen the request
+bool neverReachedServer(CURLcode result) {
+    switch (result) {
+    case CURLE_COULDNT_RESOLVE_PROXY:
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_SSL_CONNECT_ERROR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief curl failures that may go away on their own
+bool transientTransferError(CURLcode result) {
+    switch (result) {
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_HTTP2:
+    case CURLE_HTTP2_STREAM:
+        return true;
+    default:
+        return neverReachedServer(result);
+    }
+}
+
+double uniformRandom() {
+    thread_local std::mt19937 rng(std::random_device{}());
+    return std::uniform_real_distribution<double>(0, 1)(rng);
+}
+
+} // namespace
+
+/**********************************  RetryPolicy ***********************************************/
+
+bool RetryPolicy::retryable(const std::string& endpoint, CURLcode result, long httpCode,
+    const std::string& errorCodeName) const {
+
+    bool rejected = httpCode == 429 || errorCodeName.rfind("RATE_LIMIT", 0) == 0;
+    if (nonIdempotentEndpoints.count(endpoint)) {
+        // Only when the server cannot have acted on it
+        return (result != CURLE_OK && neverReachedServer(result)) || (result == CURLE_OK && rejected);
+    }
+
+    if (result != CURLE_OK) return transientTransferError(result);
+    return rejected || httpCode == 500 || httpCode == 502 || httpCode == 503 || httpCode == 504;
+}
+
+std::chrono::milliseconds RetryPolicy::backoff(int attempt, std::chrono::seconds retryAfter) const {
+    double delay = static_cast<double>(initialBackoff.count()) * std::pow(backoffMultiplier, std::max(0, attempt - 1));
+    delay = std::min(delay, static_cast<double>(maxBackoff.count()));
+    delay *= 1.0 - std::clamp(jitter, 0.0, 1.0) * uniformRandom();
+
+    auto jittered = std::chrono::milliseconds(static_cast<long long>(delay));
+    return std::max<std::chrono::milliseconds>(jittered, retryAfter);
+}
+
+/**********************************  RetryBudget ***********************************************/
+
+void RetryBudget::deposit(const RetryPolicy& policy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tokens < 0) tokens = policy.budgetMax;
+    tokens = std::min(policy.budgetMax, tokens + policy.budgetRatio);
+}
+
+bool RetryBudget::withdraw(const RetryPolicy& policy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tokens < 0) tokens = policy.budgetMax;
+    if (tokens < 1) return false;
+    tokens -= 1;
+    return true;
+}
+
+/**********************************  Retry API Functions ***********************************************/
+
+void USGS_M2M_API::setRetryPolicy(const RetryPolicy& policy) {
+    auto next = std::make_shared<const RetryPolicy>(policy);
+    std::lock_guard<std::mutex> lock(retryMutex);
+    retryPolicy = std::move(next);
+}
+
+RetryPolicy USGS_M2M_API::getRetryPolicy() const {
+    return *currentRetryPolicy();
+}
+
+std::shared_ptr<const RetryPolicy> USGS_M2M_API::currentRetryPolicy() const {
+    std::lock_guard<std::mutex> lock(retryMutex);
+    return retryPolicy;
+}
+
+std::optional<std::chrono::milliseconds> USGS_M2M_API::retryDelay(const RetryPolicy& policy, const std::string& url,
+    int attempt, CURLcode result, long httpCode, bool success, const ErrorResponse& errorData, const RequestTiming& timing,
+    std::optional<RequestDeadline::Clock::time_point> deadline) {
+
+    if (attempt == 1) retryBudget.deposit(policy);
+    if (success || attempt >= policy.maxAttempts) return std::nullopt;
+
+    std::string endpoint = url.substr(url.find_last_of('/') + 1);
+    if (!policy.retryable(endpoint, result, httpCode, errorData.errorCodeName.value_or(""))) return std::nullopt;
+
+    std::chrono::milliseconds delay = policy.backoff(attempt, timing.retryAfter);
+    if (deadline && RequestDeadline::Clock::now() + delay >= *deadline) return std::nullopt;
+    if (!retryBudget.withdraw(policy)) return std::nullopt;
+    return delay;
+}
@@ -38,9 +38,7 @@ DefaultResponse USGS_M2M_API::sceneListAdd(
     if (timeToLive) payload["timeToLive"] = *timeToLive;
     if (checkDownloadRestriction) payload["checkDownloadRestriction"] = *checkDownloadRestriction;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-list-add", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-list-add", payload);
 }
 
 /// @brief Retrieves items from a given scene list
@@ -70,9 +68,7 @@ DefaultResponse USGS_M2M_API::sceneListGet(
     if (startingNumber) payload["startingNumber"] = *startingNumber;
     if (maxResults) payload["maxResults"] = *maxResults;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-list-get", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-list-get", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneListRemove(
@@ -96,9 +92,7 @@ DefaultResponse USGS_M2M_API::sceneListRemove(
     if (entityId) payload["entityId"] = *entityId;
     if (entityIds) payload["entityIds"] = *entityIds;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-list-remove", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-list-remove", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneListSummary(
@@ -118,20 +112,15 @@ DefaultResponse USGS_M2M_API::sceneListSummary(
     payload["listId"] = listId;
     if (datasetName) payload["datasetName"] = *datasetName;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-list-summary", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-list-summary", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneListTypes(const std::optional<std::string>& listFilter) {
-    DefaultResponse result;
     nlohmann::json payload;
 
     if (listFilter) payload["listFilter"] = *listFilter;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-list-types", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-list-types", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneMetadata(
@@ -167,9 +156,7 @@ DefaultResponse USGS_M2M_API::sceneMetadata(
     if (includeNullMetadataValues) payload["includeNullMetadataValues"] = *includeNullMetadataValues;
     if (useCustomization) payload["useCustomization"] = *useCustomization;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-metadata", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-metadata", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneMetadataList(
@@ -196,9 +183,7 @@ DefaultResponse USGS_M2M_API::sceneMetadataList(
     if (includeNullMetadataValues) payload["includeNullMetadataValues"] = *includeNullMetadataValues;
     if (useCustomization) payload["useCustomization"] = *useCustomization;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-metadata-list", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-metadata-list", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneMetadataXml(
@@ -228,9 +213,7 @@ DefaultResponse USGS_M2M_API::sceneMetadataXml(
 
     if (metadataType) payload["metadataType"] = *metadataType;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-metadata-xml", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-metadata-xml", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneSearch(
@@ -284,9 +267,7 @@ DefaultResponse USGS_M2M_API::sceneSearch(
         payload["sceneFilter"] = *sceneFilter;
     }
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-search", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-search", payload);
 }
 
 DefaultResponse USGS_M2M_API::sceneSearchDelete(
@@ -321,9 +302,7 @@ DefaultResponse USGS_M2M_API::sceneSearchDelete(
         payload["temporalFilter"] = tempJson;
     }
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-search-delete", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-search-delete", payload);
 }
 
 
@@ -363,8 +342,6 @@ DefaultResponse USGS_M2M_API::sceneSearchSecondary(
     if (orderListName) payload["orderListName"] = *orderListName;
     if (excludeListName) payload["excludeListName"] = *excludeListName;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "scene-search-secondary", result.data, jsonPayload);
+    return defaultJsonResponseParsing("scene-search-secondary", payload);
 }
 
@@ -0,0 +1,152 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the download sinks
+
+#include "usgsm2m_sink.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**********************************  FileSink ***********************************************/
+
+FileSink::FileSink(std::string filePath, const FileSinkOptions& sinkOptions)
+    : path(std::move(filePath)), partPath(path + ".part"), options(sinkOptions) {}
+
+FileSink::~FileSink() {
+    dropDirect();
+    if (fd >= 0) ::close(fd);
+}
+
+bool FileSink::open(long long totalBytes, std::string& error) {
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (options.keepExisting ? 0 : O_TRUNC);
+    fd = ::open(partPath.c_str(), flags, 0644);
+    if (fd < 0) {
+        error = "Failed to open " + partPath + ": " + std::strerror(errno);
+        return false;
+    }
+    if (totalBytes > 0) {
+        // Reserving the blocks up front keeps the file contiguous while ranges land out of order
+        int result = posix_fallocate(fd, 0, totalBytes);
+        if (result == ENOSPC) {
+            error = "Not enough disk space for " + path + ".";
+            return false;
+        }
+        if (result != 0 && ::ftruncate(fd, totalBytes) != 0) {
+            error = "Failed to size " + partPath + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+
+    if (options.direct) {
+        directFd = ::open(partPath.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+        void* buffer = nullptr;
+        if (directFd >= 0 && posix_memalign(&buffer, DirectAlignment, DirectBufferBytes) == 0) {
+            bounce = static_cast<char*>(buffer);
+        } else {
+            dropDirect();
+        }
+    }
+    return true;
+}
+
+bool FileSink::write(long long offset, const char* data, size_t size, std::string& error) {
+    if (directFd >= 0) {
+        // Only whole aligned blocks can bypass the page cache, the edges share blocks with the neighbouring writes
+        long long alignment = static_cast<long long>(DirectAlignment);
+        long long end = offset + static_cast<long long>(size);
+        long long directBegin = (offset + alignment - 1) / alignment * alignment;
+        long long directEnd = end / alignment * alignment;
+        if (directBegin < directEnd) {
+            size_t head = static_cast<size_t>(directBegin - offset);
+            if (!writeAt(fd, data, head, offset)) {
+                error = "Failed to write " + path + ": " + std::strerror(errno);
+                return false;
+            }
+            long long position = directBegin;
+            while (position < directEnd && directFd >= 0) {
+                size_t count = static_cast<size_t>(std::min<long long>(directEnd - position, DirectBufferBytes));
+                std::memcpy(bounce, data + (position - offset), count);
+                if (!writeAt(directFd, bounce, count, position)) {
+                    if (errno != EINVAL) {
+                        error = "Failed to write " + path + ": " + std::strerror(errno);
+                        return false;
+                    }
+                    dropDirect();
+                    break;
+                }
+                position += static_cast<long long>(count);
+            }
+            data += position - offset;
+            size -= static_cast<size_t>(position - offset);
+            offset = position;
+        }
+    }
+
+    if (!writeAt(fd, data, size, offset)) {
+        error = "Failed to write " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool FileSink::sync(std::string& error) {
+    if (fd >= 0 && ::fdatasync(fd) != 0) {
+        error = "Failed to sync " + partPath + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool FileSink::close(bool success, std::string& error) {
+    dropDirect();
+    if (fd >= 0) {
+        int result = ::close(fd);
+        fd = -1;
+        if (result != 0 && success) {
+            error = "Failed to close " + path + ".";
+            success = false;
+        }
+    }
+    if (success && std::rename(partPath.c_str(), path.c_str()) != 0) {
+        error = "Failed to rename " + partPath + ": " + std::strerror(errno);
+        success = false;
+    }
+    if (!success && !options.keepOnFailure) ::unlink(partPath.c_str());
+    return success;
+}
+
+bool FileSink::writeAt(int fd, const char* data, size_t size, long long offset) {
+    while (size > 0) {
+        ssize_t count = ::pwrite(fd, data, size, offset);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        data += count;
+        size -= static_cast<size_t>(count);
+        offset += count;
+    }
+    return true;
+}
+
+void FileSink::dropDirect() {
+    if (directFd >= 0) ::close(directFd);
+    directFd = -1;
+    std::free(bounce);
+    bounce = nullptr;
+}
+
+/**********************************  CallbackSink ***********************************************/
+
+bool CallbackSink::write(long long offset, const char* data, size_t size, std::string& error) {
+    if (writer(offset, data, size)) return true;
+    error = "Download sink rejected the data.";
+    return false;
+}
+
+bool CallbackSink::close(bool success, std::string&) {
+    if (onClose) onClose(success);
+    return success;
+}
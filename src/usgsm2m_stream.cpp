@@ -0,0 +1,240 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the streaming USGS M2M API C++ methods
+
+#include "usgsm2m.hpp"
+#include <thread>
+
+/**********************************  JsonRecordStream ***********************************************/
+
+JsonRecordStream::JsonRecordStream(std::vector<std::vector<std::string>> arrayPaths, RecordHandler onRecord)
+    : arrayPaths(std::move(arrayPaths)), onRecord(std::move(onRecord)) {}
+
+size_t JsonRecordStream::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    JsonRecordStream* stream = static_cast<JsonRecordStream*>(userp);
+    size_t totalSize = size * nmemb;
+    // Returning less than totalSize makes curl abort the transfer
+    return stream->feed(static_cast<const char*>(contents), totalSize) ? totalSize : 0;
+}
+
+bool JsonRecordStream::atArrayPath() const {
+    for (const auto& path : arrayPaths) {
+        if (path.size() != stack.size()) continue;
+
+        bool matches = true;
+        for (size_t i = 0; i < path.size() && matches; ++i) {
+            matches = !stack[i].isArray && (path[i] == "*" || path[i] == stack[i].key);
+        }
+        if (matches) return true;
+    }
+    return false;
+}
+
+bool JsonRecordStream::emitRecord() {
+    if (recordText.empty()) return true;
+
+    nlohmann::json record;
+    try {
+        record = nlohmann::json::parse(recordText);
+    } catch (const std::exception& e) {
+        errorText = std::string("JSON parse error: ") + e.what();
+        return false;
+    }
+    recordText.clear();
+    ++records;
+
+    if (onRecord && !onRecord(std::move(record))) {
+        stopRequested = true;
+        return false;
+    }
+    return true;
+}
+
+bool JsonRecordStream::feed(const char* data, size_t size) {
+    if (failed() || stopped()) return false;
+
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+
+        if (splitting) {
+            if (inString) {
+                recordText += c;
+                if (escape) escape = false;
+                else if (c == '\\') escape = true;
+                else if (c == '"') inString = false;
+                continue;
+            }
+
+            if (recordDepth == 0) {
+                if (c == ',') {
+                    if (!emitRecord()) return false;
+                    continue;
+                }
+                if (c == ']') {
+                    if (!emitRecord()) return false;
+                    splitting = false;
+                    stack.pop_back();
+                    envelopeText += c;
+                    continue;
+                }
+                if (c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
+            }
+
+            if (c == '"') inString = true;
+            else if (c == '{' || c == '[') ++recordDepth;
+            else if (c == '}' || c == ']') --recordDepth;
+            recordText += c;
+            continue;
+        }
+
+        envelopeText += c;
+
+        if (inString) {
+            if (escape) {
+                escape = false;
+                if (stringIsKey) keyText += c;
+            } else if (c == '\\') {
+                escape = true;
+                if (stringIsKey) keyText += c;
+            } else if (c == '"') {
+                inString = false;
+                if (stringIsKey) stack.back().key = keyText;
+            } else if (stringIsKey) {
+                keyText += c;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            inString = true;
+            stringIsKey = !stack.empty() && !stack.back().isArray && stack.back().expectKey;
+            keyText.clear();
+            break;
+        case ':':
+            if (!stack.empty()) stack.back().expectKey = false;
+            break;
+        case ',':
+            if (!stack.empty() && !stack.back().isArray) stack.back().expectKey = true;
+            break;
+        case '{':
+            stack.push_back(Frame{false, true, ""});
+            break;
+        case '[':
+            if (atArrayPath()) {
+                splitting = true;
+                recordDepth = 0;
+                recordText.clear();
+            }
+            stack.push_back(Frame{true, false, ""});
+            break;
+        case '}':
+        case ']':
+            if (!stack.empty()) stack.pop_back();
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+/**********************************  Streaming API Functions ***********************************************/
+
+DefaultResponse USGS_M2M_API::streamRecords(
+    const ApiCall& call,
+    const std::vector<std::vector<std::string>>& arrayPaths,
+    const RecordCallback& onRecord
+) {
+    PreparedRequest request = prepareRequest(call);
+    if (request.earlyResponse) return std::move(*request.earlyResponse);
+
+    DefaultResponse result;
+    std::shared_ptr<const RetryPolicy> policy = currentRetryPolicy();
+    std::optional<RequestDeadline::Clock::time_point> deadline = RequestDeadline::current();
+    for (int attempt = 1;; ++attempt) {
+        if (!waitForSendSlot(request.downloadCount, deadline)) {
+            result = DefaultResponse{};
+            result.errorData = deadlineExceeded();
+            return result;
+        }
+
+        CurlHandlePool::Lease handle = handlePool.acquire();
+        if (!handle) {
+            result.errorData.errorCode = -1;
+            result.errorData.errorMessage = "Failed to initialize cURL.";
+            return result;
+        }
+
+        JsonRecordStream stream(arrayPaths, onRecord);
+        std::string unused;
+        std::shared_ptr<const HeaderSet> requestHeaders = currentHeaders();
+        configureJsonRequest(handle.get(), request.url, request.jsonPayload, unused, *requestHeaders, deadline);
+        curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, JsonRecordStream::WriteCallback);
+        curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, &stream);
+        // Records are not buffered, there is no body to pre-size
+        curl_easy_setopt(handle.get(), CURLOPT_HEADERDATA, nullptr);
+
+        CURLcode res = executeTransfer(handle.get());
+        long httpCode = 0;
+        if (res == CURLE_OK) curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &httpCode);
+        RequestTiming timing;
+        collectTiming(handle.get(), timing);
+        timing.encode = request.encodeTime;
+        handle.reset();
+
+        if (stream.stopped()) {
+            // The handler has what it wanted, the rest of the body and with it the envelope are never read
+            result = DefaultResponse{};
+            result.success = true;
+            result.metaData.timing = timing;
+            recordMetrics(request.url, timing, result.errorData, true);
+        } else if (stream.failed()) {
+            result = DefaultResponse{};
+            result.errorData.errorCode = -1;
+            result.errorData.errorMessage = stream.errorMessage();
+            result.metaData.timing = timing;
+            recordMetrics(request.url, timing, result.errorData, false);
+        } else {
+            // Only the envelope is left to parse, the records were already delivered and their
+            // parsing overlapped the transfer
+            result = parseJsonResponse(stream.envelope(), httpCode, res == CURLE_OK);
+            timing.decode = result.metaData.timing.decode;
+            result.metaData.timing = timing;
+            recordMetrics(request.url, timing, result.errorData, result.success);
+            observeRateLimit(httpCode, result.errorData, timing);
+        }
+
+        // Delivered records cannot be taken back, so only an attempt that delivered none is retried
+        bool settled = result.success || stream.recordCount() > 0;
+        auto delay = retryDelay(*policy, request.url, attempt, res, httpCode, settled, result.errorData, timing, deadline);
+        if (!delay) return result;
+        std::this_thread::sleep_for(*delay);
+    }
+}
+
+DefaultResponse USGS_M2M_API::sceneSearchStreaming(
+    const std::string& datasetName,
+    int maxResults,
+    int startingNumber,
+    const SceneSearchOptions& options,
+    const RecordCallback& onRecord
+) {
+    return streamRecords([&](USGS_M2M_API& client) {
+        return client.sceneSearchPage(datasetName, maxResults, startingNumber, options);
+    }, {{"data", "results"}}, onRecord);
+}
+
+DefaultResponse USGS_M2M_API::sceneMetadataListStreaming(
+    const std::string& listId,
+    const RecordCallback& onRecord,
+    const std::optional<std::string>& datasetName,
+    const std::optional<std::string>& metadataType,
+    const std::optional<bool>& includeNullMetadataValues,
+    const std::optional<bool>& useCustomization
+) {
+    // The scenes are either data itself or grouped per dataset under data
+    return streamRecords([&](USGS_M2M_API& client) {
+        return client.sceneMetadataList(listId, datasetName, metadataType, includeNullMetadataValues, useCustomization);
+    }, {{"data"}, {"data", "*"}}, onRecord);
+}
@@ -0,0 +1,80 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of request timeouts and per-call deadlines
+
+#include "usgsm2m.hpp"
+#include <algorithm>
+
+thread_local std::optional<RequestDeadline::Clock::time_point> RequestDeadline::active;
+
+/**********************************  RequestDeadline ***********************************************/
+
+RequestDeadline::RequestDeadline(std::chrono::milliseconds budget)
+    : RequestDeadline(Clock::now() + budget) {}
+
+RequestDeadline::RequestDeadline(Clock::time_point deadline)
+    : previous(active) {
+    active = previous ? std::min(*previous, deadline) : deadline;
+}
+
+RequestDeadline::~RequestDeadline() {
+    active = previous;
+}
+
+std::optional<RequestDeadline::Clock::time_point> RequestDeadline::current() {
+    return active;
+}
+
+/**********************************  Timeout API Functions ***********************************************/
+
+void USGS_M2M_API::setTimeouts(const TimeoutConfig& timeouts) {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    defaultTimeouts = timeouts;
+}
+
+TimeoutConfig USGS_M2M_API::getTimeouts() const {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    return defaultTimeouts;
+}
+
+void USGS_M2M_API::setEndpointTimeouts(const std::string& endpoint, const TimeoutConfig& timeouts) {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    endpointTimeouts[endpoint] = timeouts;
+}
+
+void USGS_M2M_API::clearEndpointTimeouts(const std::string& endpoint) {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    endpointTimeouts.erase(endpoint);
+}
+
+TimeoutConfig USGS_M2M_API::timeoutsFor(const std::string& url) const {
+    std::string endpoint = url.substr(url.find_last_of('/') + 1);
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    auto it = endpointTimeouts.find(endpoint);
+    return it != endpointTimeouts.end() ? it->second : defaultTimeouts;
+}
+
+void USGS_M2M_API::applyTimeouts(CURL* handle, const std::string& url,
+    std::optional<RequestDeadline::Clock::time_point> deadline, RequestDeadline::Clock::time_point startAt) {
+
+    TimeoutConfig timeouts = timeoutsFor(url);
+    long long total = timeouts.total.count();
+    if (deadline) {
+        // Whatever is left of the deadline once the attempt starts, at least 1 ms since 0 means no limit
+        long long left = std::chrono::ceil<std::chrono::milliseconds>(*deadline - startAt).count();
+        left = std::max<long long>(1, left);
+        total = total > 0 ? std::min(total, left) : left;
+    }
+
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(total));
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(timeouts.connect.count()));
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, timeouts.lowSpeedBytes);
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(timeouts.lowSpeedTime.count()));
+}
+
+ErrorResponse USGS_M2M_API::deadlineExceeded() {
+    ErrorResponse error;
+    error.errorCode = -1;
+    error.errorMessage = "Deadline exceeded.";
+    return error;
+}
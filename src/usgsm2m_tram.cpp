@@ -37,9 +37,7 @@ DefaultResponse USGS_M2M_API::tramOrderDetailUpdate(
     payload["detailKey"]   = detailKey;
     payload["detailValue"] = detailValue;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "tram-order-detail-update", result.data, jsonPayload);
+    return defaultJsonResponseParsing("tram-order-detail-update", payload);
 }
 
 DefaultResponse USGS_M2M_API::tramOrderDetails(
@@ -57,9 +55,7 @@ DefaultResponse USGS_M2M_API::tramOrderDetails(
     nlohmann::json payload;
     payload["orderNumber"] = orderNumber;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "tram-order-details", result.data, jsonPayload);
+    return defaultJsonResponseParsing("tram-order-details", payload);
 }
 
 DefaultResponse USGS_M2M_API::tramOrderDetailsClear(
@@ -77,9 +73,7 @@ DefaultResponse USGS_M2M_API::tramOrderDetailsClear(
     nlohmann::json payload;
     payload["orderNumber"] = orderNumber;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "tram-order-details-clear", result.data, jsonPayload);
+    return defaultJsonResponseParsing("tram-order-details-clear", payload);
 }
 
 DefaultResponse USGS_M2M_API::tramOrderDetailsRemove(
@@ -106,9 +100,7 @@ DefaultResponse USGS_M2M_API::tramOrderDetailsRemove(
     payload["orderNumber"] = orderNumber;
     payload["detailKey"] = detailKey;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "tram-order-details-remove", result.data, jsonPayload);
+    return defaultJsonResponseParsing("tram-order-details-remove", payload);
 }
 
 DefaultResponse USGS_M2M_API::tramOrderSearch(
@@ -119,8 +111,6 @@ DefaultResponse USGS_M2M_API::tramOrderSearch(
     const std::optional<std::string>& sortField,
     const std::optional<std::vector<std::string>>& statusFilter
 ) {
-    DefaultResponse result;
-
     nlohmann::json payload;
 
     if (orderId) payload["orderId"] = *orderId;
@@ -130,9 +120,7 @@ DefaultResponse USGS_M2M_API::tramOrderSearch(
     if (sortField) payload["sortField"] = *sortField;
     if (statusFilter && !statusFilter->empty()) payload["statusFilter"] = *statusFilter;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "tram-order-search", result.data, jsonPayload);
+    return defaultJsonResponseParsing("tram-order-search", payload);
 }
 
 DefaultResponse USGS_M2M_API::tramOrderStatus(const std::string& orderNumber) {
@@ -148,9 +136,7 @@ DefaultResponse USGS_M2M_API::tramOrderStatus(const std::string& orderNumber) {
     nlohmann::json payload;
     payload["orderNumber"] = orderNumber;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "tram-order-status", result.data, jsonPayload);
+    return defaultJsonResponseParsing("tram-order-status", payload);
 }
 
 DefaultResponse USGS_M2M_API::tramOrderUnits(const std::string& orderNumber) {
@@ -166,7 +152,5 @@ DefaultResponse USGS_M2M_API::tramOrderUnits(const std::string& orderNumber) {
     nlohmann::json payload;
     payload["orderNumber"] = orderNumber;
 
-    std::string jsonPayload = payload.dump();
-
-    return defaultJsonResponseParsing(API_URL + "tram-order-units", result.data, jsonPayload);
+    return defaultJsonResponseParsing("tram-order-units", payload);
 }
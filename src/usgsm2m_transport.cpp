@@ -0,0 +1,181 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Implementation of the shared curl transport pieces
+
+#include "usgsm2m_transport.hpp"
+#include <algorithm>
+
+/**********************************  HeaderSet ***********************************************/
+
+HeaderSet::HeaderSet(std::vector<std::string> headerLines) : lines(std::move(headerLines)) {
+    for (auto& hdr : lines) {
+        list = curl_slist_append(list, hdr.c_str());
+        compressedBodyList = curl_slist_append(compressedBodyList, hdr.c_str());
+    }
+    compressedBodyList = curl_slist_append(compressedBodyList, "Content-Encoding: gzip");
+}
+
+HeaderSet::~HeaderSet() {
+    if (list) curl_slist_free_all(list);
+    if (compressedBodyList) curl_slist_free_all(compressedBodyList);
+}
+
+/**********************************  CurlShareCache ***********************************************/
+
+void CurlShareCache::ensureGlobalInit() {
+    static std::once_flag initOnce;
+    // curl_global_init is not thread-safe and curl_global_cleanup would pull the rug from
+    // under every other client, so it runs once and stays initialized for the process lifetime
+    std::call_once(initOnce, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+CurlShareCache& CurlShareCache::instance() {
+    ensureGlobalInit();
+    // Never destroyed: handles may still be attached while static destructors run
+    static CurlShareCache* cache = new CurlShareCache();
+    return *cache;
+}
+
+CurlShareCache::CurlShareCache() {
+    share = curl_share_init();
+    if (!share) return;
+
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockData);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockData);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    // Not CURL_LOCK_DATA_CONNECT: libcurl does not support a connection cache shared by handles
+    // running on several threads at once. Pooled handles and the multi handle keep their own.
+}
+
+void CurlShareCache::attach(CURL* handle) const {
+    if (share && handle) curl_easy_setopt(handle, CURLOPT_SHARE, share);
+}
+
+void CurlShareCache::lockData(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<CurlShareCache*>(userptr)->locks[data].lock();
+}
+
+void CurlShareCache::unlockData(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<CurlShareCache*>(userptr)->locks[data].unlock();
+}
+
+/**********************************  CurlHandlePool ***********************************************/
+
+CurlHandlePool::Lease& CurlHandlePool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool = other.pool;
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+void CurlHandlePool::Lease::reset() {
+    if (handle && pool) pool->release(handle);
+    handle = nullptr;
+}
+
+CurlHandlePool::CurlHandlePool(size_t maxIdle, const CurlShareCache* shareCache)
+    : maxIdle(maxIdle), shareCache(shareCache) {}
+
+CurlHandlePool::~CurlHandlePool() {
+    for (CURL* handle : idle) curl_easy_cleanup(handle);
+    idle.clear();
+}
+
+CurlHandlePool::Lease CurlHandlePool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idle.empty()) {
+            CURL* handle = idle.back();
+            idle.pop_back();
+            return Lease(this, handle);
+        }
+    }
+    CURL* handle = curl_easy_init();
+    if (handle && shareCache) shareCache->attach(handle);
+    return Lease(this, handle);
+}
+
+void CurlHandlePool::release(CURL* handle) {
+    if (!handle) return;
+
+    // Drops every option set for the last request, connections and caches survive
+    curl_easy_reset(handle);
+    if (shareCache) shareCache->attach(handle);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.size() < maxIdle) {
+            idle.push_back(handle);
+            return;
+        }
+    }
+    curl_easy_cleanup(handle);
+}
+
+void CurlHandlePool::setMaxIdle(size_t limit) {
+    std::vector<CURL*> surplus;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxIdle = limit;
+        while (idle.size() > maxIdle) {
+            surplus.push_back(idle.back());
+            idle.pop_back();
+        }
+    }
+    for (CURL* handle : surplus) curl_easy_cleanup(handle);
+}
+
+/**********************************  ResponseBufferPool ***********************************************/
+
+ResponseBufferPool::ResponseBufferPool(size_t maxIdle, size_t maxRetainedBytes)
+    : maxIdle(maxIdle), maxRetainedBytes(maxRetainedBytes) {}
+
+std::string ResponseBufferPool::acquire(std::string_view endpoint) {
+    std::string buffer;
+    double expected = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idle.empty()) {
+            buffer = std::move(idle.back());
+            idle.pop_back();
+        }
+        auto it = expectedSize.find(endpoint);
+        if (it != expectedSize.end()) expected = it->second * Headroom;
+    }
+
+    // Allocating outside the lock, other threads only wait for the bookkeeping
+    buffer.reserve(std::min(static_cast<size_t>(expected), MaxPresize));
+    return buffer;
+}
+
+void ResponseBufferPool::release(std::string_view endpoint, std::string buffer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!buffer.empty()) {
+        double size = static_cast<double>(buffer.size());
+        auto it = expectedSize.find(endpoint);
+        if (it == expectedSize.end()) {
+            expectedSize.emplace(std::string(endpoint), size);
+        } else {
+            it->second += SizeWeight * (size - it->second);
+        }
+    }
+
+    // A buffer not kept is freed once the lock is released
+    if (buffer.capacity() > maxRetainedBytes || idle.size() >= maxIdle) return;
+    buffer.clear();
+    idle.push_back(std::move(buffer));
+}
+
+void ResponseBufferPool::setLimits(size_t idleLimit, size_t retainedLimit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxIdle = idleLimit;
+    maxRetainedBytes = retainedLimit;
+    auto oversized = std::remove_if(idle.begin(), idle.end(),
+        [&](const std::string& buffer) { return buffer.capacity() > maxRetainedBytes; });
+    idle.erase(oversized, idle.end());
+    if (idle.size() > maxIdle) idle.resize(maxIdle);
+}
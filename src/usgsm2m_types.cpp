@@ -0,0 +1,233 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Decoders turning USGS M2M JSON responses into typed structs
+
+#include "usgsm2m.hpp"
+#include "usgsm2m_time.hpp"
+#include <cctype>
+#include <cstdio>
+
+namespace {
+
+/// @brief Find a string member without creating it
+const std::string* findString(const nlohmann::json& j, const char* key) {
+    auto it = j.find(key);
+    if (it == j.end() || !it->is_string()) return nullptr;
+    return it->get_ptr<const std::string*>();
+}
+
+std::optional<int> findInt(const nlohmann::json& j, const char* key) {
+    auto it = j.find(key);
+    if (it == j.end()) return std::nullopt;
+    if (it->is_number_integer()) return it->get<int>();
+    if (it->is_string()) {
+        try { return std::stoi(it->get_ref<const std::string&>()); }
+        catch (...) { return std::nullopt; }
+    }
+    return std::nullopt;
+}
+
+/// @brief Seconds east of UTC of a "Z", "±hh", "±hhmm" or "±hh:mm" suffix, 0 if there is none
+long utcOffset(const char* suffix) {
+    if (*suffix == '.') {
+        ++suffix;
+        while (std::isdigit(static_cast<unsigned char>(*suffix))) ++suffix;
+    }
+    while (*suffix == ' ') ++suffix;
+    if (*suffix != '+' && *suffix != '-') return 0;
+    long sign = *suffix == '-' ? -1 : 1;
+    ++suffix;
+
+    auto twoDigits = [](const char* p, long& value) {
+        if (!std::isdigit(static_cast<unsigned char>(p[0])) || !std::isdigit(static_cast<unsigned char>(p[1]))) {
+            return false;
+        }
+        value = (p[0] - '0') * 10 + (p[1] - '0');
+        return true;
+    };
+    long hours = 0;
+    long minutes = 0;
+    if (!twoDigits(suffix, hours)) return 0;
+    suffix += 2;
+    if (*suffix == ':') ++suffix;
+    twoDigits(suffix, minutes);
+    return sign * (hours * 3600 + minutes * 60);
+}
+
+time_t findTime(const nlohmann::json& j, const char* key) {
+    const std::string* text = findString(j, key);
+    return text ? parseM2MTime(*text) : -1;
+}
+
+/// @brief Outer ring of a GeoJSON Polygon, or of the first polygon of a MultiPolygon
+void decodeFootprint(const nlohmann::json& geometry, std::vector<std::array<double, 2>>& ring) {
+    auto coordinates = geometry.find("coordinates");
+    if (coordinates == geometry.end() || !coordinates->is_array() || coordinates->empty()) return;
+
+    const nlohmann::json* outer = &(*coordinates)[0];
+    const std::string* type = findString(geometry, "type");
+    if (type && *type == "MultiPolygon") {
+        if (!outer->is_array() || outer->empty()) return;
+        outer = &(*outer)[0];
+    }
+    if (!outer->is_array()) return;
+
+    ring.reserve(outer->size());
+    for (const auto& point : *outer) {
+        if (point.is_array() && point.size() >= 2 && point[0].is_number() && point[1].is_number()) {
+            ring.push_back({point[0].get<double>(), point[1].get<double>()});
+        }
+    }
+}
+
+template <typename TypedResponse>
+void copyStatus(DefaultResponse& response, TypedResponse& typed) {
+    typed.errorData = std::move(response.errorData);
+    typed.metaData = std::move(response.metaData);
+    typed.success = response.success;
+}
+
+} // namespace
+
+time_t parseM2MTime(const std::string& text) {
+    std::tm tm{};
+    int consumed = 0;
+    int fields = std::sscanf(text.c_str(), "%d-%d-%d%*c%d:%d:%d%n",
+        &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &consumed);
+    if (fields < 3) return -1;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    time_t local = timegm(&tm);
+    if (fields < 6 || consumed == 0 || local == -1) return local;
+    return local - utcOffset(text.c_str() + consumed);
+}
+
+bool decodeSceneResult(const nlohmann::json& scene, SceneResult& out) {
+    if (!scene.is_object()) return false;
+
+    const std::string* entityId = findString(scene, "entityId");
+    if (!entityId) return false;
+    out.entityId = *entityId;
+
+    if (const std::string* displayId = findString(scene, "displayId")) out.displayId = *displayId;
+    if (const std::string* orderingId = findString(scene, "orderingId")) out.orderingId = *orderingId;
+    out.publishDate = findTime(scene, "publishDate");
+
+    auto temporal = scene.find("temporalCoverage");
+    if (temporal != scene.end() && temporal->is_object()) {
+        out.acquisitionDate = findTime(*temporal, "startDate");
+    }
+
+    // cloudCover comes as a number or a numeric string, -1 means unknown
+    auto cloud = scene.find("cloudCover");
+    if (cloud != scene.end()) {
+        std::optional<float> value;
+        if (cloud->is_number()) value = cloud->get<float>();
+        else if (cloud->is_string()) {
+            try { value = std::stof(cloud->get_ref<const std::string&>()); }
+            catch (...) {}
+        }
+        if (value && *value >= 0) out.cloudCover = value;
+    }
+
+    auto footprint = scene.find("spatialCoverage");
+    if (footprint == scene.end() || !footprint->is_object()) footprint = scene.find("spatialBounds");
+    if (footprint != scene.end() && footprint->is_object()) decodeFootprint(*footprint, out.footprint);
+
+    return true;
+}
+
+SceneSearchResponse decodeSceneSearchResponse(DefaultResponse&& response) {
+    SceneSearchResponse typed;
+    copyStatus(response, typed);
+    if (!response.success || !response.data.is_object()) return typed;
+
+    const nlohmann::json& data = response.data;
+    typed.totalHits = findInt(data, "totalHits").value_or(0);
+    typed.recordsReturned = findInt(data, "recordsReturned").value_or(0);
+    typed.nextRecord = findInt(data, "nextRecord");
+
+    auto results = data.find("results");
+    if (results != data.end() && results->is_array()) {
+        typed.results.reserve(results->size());
+        for (const auto& scene : *results) {
+            SceneResult decoded;
+            if (decodeSceneResult(scene, decoded)) typed.results.push_back(std::move(decoded));
+        }
+    }
+    response.data = nullptr;
+    return typed;
+}
+
+SceneMetadataResponse decodeSceneMetadataResponse(DefaultResponse&& response) {
+    SceneMetadataResponse typed;
+    copyStatus(response, typed);
+    if (!response.success || !response.data.is_object()) return typed;
+
+    const nlohmann::json& data = response.data;
+    decodeSceneResult(data, typed.scene);
+
+    auto metadata = data.find("metadata");
+    if (metadata != data.end() && metadata->is_array()) {
+        typed.metadata.reserve(metadata->size());
+        for (const auto& field : *metadata) {
+            if (!field.is_object()) continue;
+            SceneMetadataField decoded;
+            auto id = field.find("id");
+            if (id != field.end() && !id->is_null()) decoded.id = id->is_string() ? id->get<std::string>() : id->dump();
+            if (const std::string* name = findString(field, "fieldName")) decoded.fieldName = *name;
+            auto value = field.find("value");
+            if (value != field.end() && !value->is_null()) {
+                decoded.value = value->is_string() ? value->get<std::string>() : value->dump();
+            }
+            typed.metadata.push_back(std::move(decoded));
+        }
+    }
+    response.data = nullptr;
+    return typed;
+}
+
+SceneListResponse decodeSceneListResponse(DefaultResponse&& response) {
+    SceneListResponse typed;
+    copyStatus(response, typed);
+    if (!response.success || !response.data.is_array()) return typed;
+
+    typed.entries.reserve(response.data.size());
+    for (const auto& item : response.data) {
+        if (!item.is_object()) continue;
+        SceneListEntry entry;
+        if (const std::string* entityId = findString(item, "entityId")) entry.entityId = *entityId;
+        if (const std::string* datasetName = findString(item, "datasetName")) entry.datasetName = *datasetName;
+        typed.entries.push_back(std::move(entry));
+    }
+    response.data = nullptr;
+    return typed;
+}
+
+/**********************************  Typed API Functions ***********************************************/
+
+SceneSearchResponse USGS_M2M_API::sceneSearchTyped(
+    const std::string& datasetName,
+    int maxResults,
+    int startingNumber,
+    const SceneSearchOptions& options
+) {
+    return decodeSceneSearchResponse(sceneSearchPage(datasetName, maxResults, startingNumber, options));
+}
+
+SceneMetadataResponse USGS_M2M_API::sceneMetadataTyped(
+    const std::string& datasetName,
+    const std::string& entityId,
+    const std::optional<std::string>& metadataType
+) {
+    return decodeSceneMetadataResponse(sceneMetadata(datasetName, entityId, std::nullopt, metadataType));
+}
+
+SceneListResponse USGS_M2M_API::sceneListGetTyped(
+    const std::string& listId,
+    const std::optional<std::string>& datasetName,
+    const std::optional<int>& startingNumber,
+    const std::optional<int>& maxResults
+) {
+    return decodeSceneListResponse(sceneListGet(listId, datasetName, startingNumber, maxResults));
+}
@@ -0,0 +1,561 @@
+/// @author Alexander Stackpoole
+/// @date 10/16/26
+/// @brief Local stand-in for the USGS M2M API, for offline testing and benchmarking.
+///
+/// Serves every endpoint under /api/ as POST or GET. A response recorded with
+/// USGS_M2M_API::setResponseRecorder (<responses>/<endpoint>.json) is served verbatim,
+/// otherwise login*, logout, dataset-search, scene-search, download-request, download-retrieve,
+/// tram-order-status, placename and rate-limit-summary are synthesized. /files/<name> serves generated bytes with Range support
+/// for download tests. gzip request bodies are accepted and API responses of at least 1 KiB are
+/// gzipped when the client accepts it. Point the client at it with setBaseUrl("http://127.0.0.1:<port>/api/").
+///
+/// Usage: m2m_standin [options]
+///   --port N              Port to listen on (default 8080)
+///   --responses DIR       Directory of recorded <endpoint>.json responses
+///   --latency-ms N        Delay before every response (default 0)
+///   --jitter-ms N         Extra uniformly random delay up to N ms (default 0)
+///   --error-rate F        Fraction of API requests answered with an error (default 0)
+///   --error-kind KIND     http500, rate-limit (HTTP 429) or m2m (HTTP 200 with errorCode)
+///   --total-hits N        Scenes matched by scene-search (default 1000)
+///   --metadata-fields N   Metadata fields per synthesized scene, scales the payload (default 0)
+///   --file-size N         Bytes served for each /files/ download (default 1048576)
+///   --rate-limit N        API requests per second before answering HTTP 429 RATE_LIMIT (default 0, unlimited)
+///   --download-limit N    recentDownloadCount limit reported by rate-limit-summary (default 15000)
+///   --prepare-ms N        Requested downloads stay in preparingDownloads for N ms before download-retrieve
+///                         lists them as available (default 0, available immediately)
+
+#include <nlohmann/json.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Options {
+    int port = 8080;
+    std::string responses;
+    int latencyMs = 0;
+    int jitterMs = 0;
+    double errorRate = 0;
+    std::string errorKind = "http500";
+    int totalHits = 1000;
+    int metadataFields = 0;
+    long long fileSize = 1 << 20;
+    double rateLimit = 0;
+    int downloadLimit = 15000;
+    int prepareMs = 0;
+};
+
+struct Request {
+    std::string method;
+    std::string path;
+    std::string range;
+    std::string body;
+    bool keepAlive = true;
+    bool gzipBody = false;
+    bool acceptsGzip = false;
+};
+
+struct Response {
+    int status = 200;
+    std::string body;
+    std::string contentType = "application/json";
+    std::string extraHeaders;
+    /// @brief Whether body may be sent gzipped
+    bool compressible = false;
+    /// @brief Generated file bytes [fileStart, fileStart + fileLength) instead of body
+    bool fileBody = false;
+    long long fileStart = 0;
+    long long fileLength = 0;
+};
+
+Options options;
+std::atomic<long> requestCounter{0};
+std::atomic<long> downloadCounter{0};
+
+/// @brief A download handed out by download-request, listed by download-retrieve
+struct StagedDownload {
+    long downloadId;
+    std::string entityId;
+    std::string url;
+    std::string label;
+    std::chrono::steady_clock::time_point readyAt;
+};
+
+std::mutex stagedMutex;
+std::vector<StagedDownload> stagedDownloads;
+
+/// @brief Byte at offset of every generated file, so clients can verify what they wrote
+unsigned char fileByte(long long offset) {
+    return static_cast<unsigned char>((offset * 31 + 7) & 0xff);
+}
+
+const char* reason(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 206: return "Partial Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 416: return "Range Not Satisfiable";
+    case 429: return "Too Many Requests";
+    default: return "Internal Server Error";
+    }
+}
+
+std::string envelope(nlohmann::json data, const nlohmann::json& errorCode = nullptr,
+    const nlohmann::json& errorMessage = nullptr) {
+    nlohmann::json out = {
+        {"requestId", ++requestCounter}, {"version", "stable"}, {"sessionId", 1},
+        {"data", std::move(data)}, {"errorCode", errorCode}, {"errorMessage", errorMessage},
+    };
+    return out.dump();
+}
+
+bool randomChance(double probability) {
+    if (probability <= 0) return false;
+    thread_local std::mt19937 rng(std::random_device{}());
+    return std::uniform_real_distribution<double>(0, 1)(rng) < probability;
+}
+
+void simulateLatency() {
+    int delay = options.latencyMs;
+    if (options.jitterMs > 0) {
+        thread_local std::mt19937 rng(std::random_device{}());
+        delay += std::uniform_int_distribution<int>(0, options.jitterMs)(rng);
+    }
+    if (delay > 0) std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+}
+
+/// @brief Server side token bucket of --rate-limit, one second of burst
+bool overRateLimit() {
+    if (options.rateLimit <= 0) return false;
+    static std::mutex mutex;
+    static double tokens = options.rateLimit;
+    static auto lastRefill = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    tokens = std::min(options.rateLimit,
+        tokens + options.rateLimit * std::chrono::duration<double>(now - lastRefill).count());
+    lastRefill = now;
+    if (tokens < 1) return true;
+    tokens -= 1;
+    return false;
+}
+
+nlohmann::json syntheticScene(int index) {
+    nlohmann::json scene = {
+        {"entityId", "LC8" + std::to_string(1000000 + index)},
+        {"displayId", "LC08_L1TP_" + std::to_string(index) + "_20200101_20200113_01_T1"},
+        {"orderingId", "LC8" + std::to_string(1000000 + index)},
+        {"cloudCover", std::to_string(index % 100)},
+        {"publishDate", "2020-01-13 00:00:00"},
+        {"temporalCoverage", {{"startDate", "2020-01-01 00:00:00"}, {"endDate", "2020-01-01 00:00:00"}}},
+        {"spatialBounds", {{"type", "Polygon"}, {"coordinates",
+            {{{-105.1, 39.7}, {-103.4, 39.7}, {-103.4, 41.5}, {-105.1, 41.5}, {-105.1, 39.7}}}}}},
+    };
+    if (options.metadataFields > 0) {
+        nlohmann::json metadata = nlohmann::json::array();
+        for (int f = 0; f < options.metadataFields; ++f) {
+            metadata.push_back({{"id", std::to_string(f)}, {"fieldName", "Field " + std::to_string(f)},
+                {"value", "value " + std::to_string(index) + "/" + std::to_string(f)}});
+        }
+        scene["metadata"] = std::move(metadata);
+    }
+    return scene;
+}
+
+std::string sceneSearch(const nlohmann::json& request) {
+    int start = std::max(1, request.value("startingNumber", 1));
+    int maxResults = std::max(0, request.value("maxResults", 100));
+
+    nlohmann::json results = nlohmann::json::array();
+    for (int i = start; i < start + maxResults && i <= options.totalHits; ++i) {
+        results.push_back(syntheticScene(i));
+    }
+    int returned = static_cast<int>(results.size());
+    nlohmann::json data = {
+        {"results", std::move(results)}, {"recordsReturned", returned}, {"totalHits", options.totalHits},
+        {"startingNumber", start}, {"nextRecord", start + returned},
+    };
+    return envelope(std::move(data));
+}
+
+std::string downloadUrl(const std::string& entityId, const std::string& productId) {
+    return "http://127.0.0.1:" + std::to_string(options.port) + "/files/" + entityId + "_" + productId + ".bin";
+}
+
+/// @brief Requested downloads are available immediately, or after --prepare-ms
+std::string downloadRequest(const nlohmann::json& request) {
+    nlohmann::json available = nlohmann::json::array();
+    nlohmann::json preparing = nlohmann::json::array();
+    std::string label = request.value("label", "");
+    auto readyAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.prepareMs);
+    auto downloads = request.find("downloads");
+    if (downloads != request.end() && downloads->is_array()) {
+        for (const auto& download : *downloads) {
+            std::string entityId = download.value("entityId", "");
+            std::string productId = download.value("productId", "");
+            ++downloadCounter;
+            long downloadId = ++requestCounter;
+            std::string url = downloadUrl(entityId, productId);
+            nlohmann::json entry = {{"downloadId", downloadId}, {"entityId", entityId},
+                {"productId", productId}, {"url", url}, {"eulaCode", nullptr}};
+            (options.prepareMs > 0 ? preparing : available).push_back(std::move(entry));
+
+            std::lock_guard<std::mutex> lock(stagedMutex);
+            stagedDownloads.push_back({downloadId, entityId, url, label, readyAt});
+        }
+    }
+    nlohmann::json data = {
+        {"availableDownloads", std::move(available)}, {"preparingDownloads", std::move(preparing)},
+        {"duplicateProducts", nlohmann::json::array()}, {"failed", nlohmann::json::array()},
+        {"newRecords", nlohmann::json::array()}, {"numInvalidScenes", 0},
+    };
+    return envelope(std::move(data));
+}
+
+/// @brief Downloads of the label, split by whether they are staged yet
+std::string downloadRetrieve(const nlohmann::json& request) {
+    std::string label = request.value("label", "");
+    nlohmann::json available = nlohmann::json::array();
+    nlohmann::json requested = nlohmann::json::array();
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(stagedMutex);
+    for (const StagedDownload& download : stagedDownloads) {
+        if (!label.empty() && download.label != label) continue;
+        bool ready = now >= download.readyAt;
+        nlohmann::json entry = {{"downloadId", download.downloadId}, {"entityId", download.entityId},
+            {"statusCode", ready ? "A" : "P"}, {"statusText", ready ? "Available" : "Preparing"}};
+        if (ready) entry["url"] = download.url;
+        (ready ? available : requested).push_back(std::move(entry));
+    }
+    size_t queueSize = requested.size();
+    return envelope({{"available", std::move(available)}, {"requested", std::move(requested)},
+        {"queueSize", queueSize}, {"eulas", nlohmann::json::array()}});
+}
+
+Response apiResponse(const std::string& endpoint, const Request& request) {
+    Response response;
+
+    if (overRateLimit()) {
+        response.status = 429;
+        response.extraHeaders = "Retry-After: 1\r\n";
+        response.body = envelope(nullptr, "RATE_LIMIT", "Rate limit exceeded.");
+        return response;
+    }
+
+    if (randomChance(options.errorRate)) {
+        if (options.errorKind == "rate-limit") {
+            response.status = 429;
+            response.body = envelope(nullptr, "RATE_LIMIT", "Rate limit exceeded.");
+        } else if (options.errorKind == "m2m") {
+            response.body = envelope(nullptr, "UNKNOWN", "Injected error.");
+        } else {
+            response.status = 500;
+            response.body = envelope(nullptr, "SERVER_ERROR", "Injected error.");
+        }
+        return response;
+    }
+
+    if (!options.responses.empty()) {
+        std::ifstream recorded(options.responses + "/" + endpoint + ".json", std::ios::binary);
+        if (recorded) {
+            std::ostringstream text;
+            text << recorded.rdbuf();
+            response.body = text.str();
+            return response;
+        }
+    }
+
+    nlohmann::json body = nlohmann::json::parse(request.body.empty() ? "{}" : request.body, nullptr, false);
+    // Endpoints called without any optional parameter send a null payload
+    if (body.is_null()) body = nlohmann::json::object();
+    if (body.is_discarded() || !body.is_object()) {
+        response.status = 400;
+        response.body = envelope(nullptr, "INPUT_FORMAT", "Request body is not a JSON object.");
+        return response;
+    }
+
+    if (endpoint.rfind("login", 0) == 0) {
+        response.body = envelope("standin-token-" + std::to_string(requestCounter.load()));
+    } else if (endpoint == "logout") {
+        response.body = envelope(nullptr);
+    } else if (endpoint == "dataset-search") {
+        nlohmann::json datasets = nlohmann::json::array();
+        for (int i = 0; i < 10; ++i) {
+            datasets.push_back({{"datasetAlias", "standin_dataset_" + std::to_string(i)},
+                {"datasetId", std::to_string(1000 + i)}, {"collectionName", "Stand-in dataset " + std::to_string(i)},
+                {"supportCloudCover", true}});
+        }
+        response.body = envelope(std::move(datasets));
+    } else if (endpoint == "scene-search") {
+        response.body = sceneSearch(body);
+    } else if (endpoint == "download-request") {
+        response.body = downloadRequest(body);
+    } else if (endpoint == "download-retrieve") {
+        response.body = downloadRetrieve(body);
+    } else if (endpoint == "tram-order-status") {
+        response.body = envelope({{"orderNumber", body.value("orderNumber", "")}, {"statusCode", "C"},
+            {"statusText", "Complete"}, {"units", nlohmann::json::array()}});
+    } else if (endpoint == "rate-limit-summary") {
+        nlohmann::json initial = {{"recentDownloadCount", options.downloadLimit}, {"pendingDownloadCount", 100},
+            {"unattemptedDownloadCount", 5000}};
+        nlohmann::json remaining = initial;
+        remaining["recentDownloadCount"] = std::max<long>(0, options.downloadLimit - downloadCounter.load());
+        response.body = envelope({{"initialLimits", nlohmann::json::array({initial})},
+            {"remainingLimits", nlohmann::json::array({remaining})},
+            {"recentDownloadCounts", nlohmann::json::array()}});
+    } else if (endpoint == "placename") {
+        response.body = envelope(nlohmann::json::array({{{"id", 1}, {"placename", body.value("name", "")},
+            {"feature_code", body.value("featureType", "")}, {"latitude", 43.5}, {"longitude", -96.7}}}));
+    } else {
+        response.status = 404;
+        response.body = envelope(nullptr, "UNKNOWN_ENDPOINT", "No recorded response for " + endpoint + ".");
+    }
+    return response;
+}
+
+Response fileResponse(const Request& request) {
+    Response response;
+    response.contentType = "application/octet-stream";
+    response.fileBody = true;
+    response.extraHeaders = "Accept-Ranges: bytes\r\n";
+
+    long long first = 0;
+    long long last = options.fileSize - 1;
+    if (!request.range.empty()) {
+        // Single "bytes=first-[last]" ranges only
+        long long a = -1, b = -1;
+        if (std::sscanf(request.range.c_str(), "bytes=%lld-%lld", &a, &b) < 1 || a < 0 || a >= options.fileSize) {
+            response.status = 416;
+            response.fileBody = false;
+            response.extraHeaders += "Content-Range: bytes */" + std::to_string(options.fileSize) + "\r\n";
+            return response;
+        }
+        first = a;
+        if (b >= a) last = std::min(b, options.fileSize - 1);
+        response.status = 206;
+        response.extraHeaders += "Content-Range: bytes " + std::to_string(first) + "-" + std::to_string(last)
+            + "/" + std::to_string(options.fileSize) + "\r\n";
+    }
+    response.fileStart = first;
+    response.fileLength = last - first + 1;
+    return response;
+}
+
+/// @brief gzip (deflate) or gunzip (inflate) a whole buffer
+bool gzip(const std::string& input, std::string& output, bool compress) {
+    z_stream zs{};
+    int status = compress ? deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)
+                          : inflateInit2(&zs, 15 + 16);
+    if (status != Z_OK) return false;
+
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zs.avail_in = static_cast<uInt>(input.size());
+    output.clear();
+    char chunk[64 * 1024];
+    do {
+        zs.next_out = reinterpret_cast<Bytef*>(chunk);
+        zs.avail_out = sizeof(chunk);
+        status = compress ? deflate(&zs, Z_FINISH) : inflate(&zs, Z_NO_FLUSH);
+        output.append(chunk, sizeof(chunk) - zs.avail_out);
+    } while (status == Z_OK);
+
+    if (compress) deflateEnd(&zs);
+    else inflateEnd(&zs);
+    return status == Z_STREAM_END;
+}
+
+bool sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool writeResponse(int fd, const Request& request, Response& response) {
+    std::string compressed;
+    if (response.compressible && request.acceptsGzip && response.body.size() >= 1024
+        && gzip(response.body, compressed, true)) {
+        response.body = std::move(compressed);
+        response.extraHeaders += "Content-Encoding: gzip\r\n";
+    }
+
+    long long length = response.fileBody ? response.fileLength : static_cast<long long>(response.body.size());
+    std::string head = "HTTP/1.1 " + std::to_string(response.status) + " " + reason(response.status) + "\r\n"
+        + "Content-Type: " + response.contentType + "\r\n"
+        + "Content-Length: " + std::to_string(length) + "\r\n"
+        + response.extraHeaders
+        + (request.keepAlive ? "" : "Connection: close\r\n") + "\r\n";
+    if (!sendAll(fd, head.data(), head.size())) return false;
+    if (request.method == "HEAD") return true;
+
+    if (!response.fileBody) return sendAll(fd, response.body.data(), response.body.size());
+
+    char chunk[64 * 1024];
+    for (long long offset = response.fileStart, end = response.fileStart + length; offset < end;) {
+        size_t n = static_cast<size_t>(std::min<long long>(sizeof(chunk), end - offset));
+        for (size_t i = 0; i < n; ++i) chunk[i] = static_cast<char>(fileByte(offset + static_cast<long long>(i)));
+        if (!sendAll(fd, chunk, n)) return false;
+        offset += static_cast<long long>(n);
+    }
+    return true;
+}
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+/// @brief Read one request from a keep-alive connection, buffer keeps bytes of the next one
+bool readRequest(int fd, std::string& buffer, Request& request) {
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        char chunk[16 * 1024];
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+
+    std::istringstream head(buffer.substr(0, headerEnd));
+    std::string line, version;
+    std::getline(head, line);
+    std::istringstream requestLine(line);
+    requestLine >> request.method >> request.path >> version;
+    request.keepAlive = version != "HTTP/1.0";
+
+    size_t contentLength = 0;
+    while (std::getline(head, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = lower(line.substr(0, colon));
+        size_t valueStart = line.find_first_not_of(' ', colon + 1);
+        std::string value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+        if (name == "content-length") contentLength = std::strtoul(value.c_str(), nullptr, 10);
+        else if (name == "range") request.range = value;
+        else if (name == "connection") request.keepAlive = lower(value) != "close";
+        else if (name == "content-encoding") request.gzipBody = lower(value) == "gzip";
+        else if (name == "accept-encoding") request.acceptsGzip = lower(value).find("gzip") != std::string::npos;
+    }
+
+    buffer.erase(0, headerEnd + 4);
+    while (buffer.size() < contentLength) {
+        char chunk[64 * 1024];
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    request.body = buffer.substr(0, contentLength);
+    buffer.erase(0, contentLength);
+
+    // An undecodable body is left as is and rejected as malformed JSON
+    std::string decoded;
+    if (request.gzipBody && gzip(request.body, decoded, false)) request.body = std::move(decoded);
+    return true;
+}
+
+void serveConnection(int fd) {
+    std::string buffer;
+    for (;;) {
+        Request request;
+        if (!readRequest(fd, buffer, request)) break;
+
+        Response response;
+        std::string path = request.path.substr(0, request.path.find('?'));
+        try {
+            if (path.rfind("/files/", 0) == 0) {
+                response = fileResponse(request);
+            } else {
+                simulateLatency();
+                response = apiResponse(path.substr(path.find_last_of('/') + 1), request);
+                response.compressible = true;
+            }
+        } catch (const std::exception& e) {
+            // e.g. a request field of the wrong type
+            response = Response{};
+            response.status = 400;
+            response.body = envelope(nullptr, "INPUT_INVALID", e.what());
+        }
+
+        if (!writeResponse(fd, request, response) || !request.keepAlive) break;
+    }
+    ::close(fd);
+}
+
+bool parseOptions(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--port") options.port = std::stoi(value);
+        else if (arg == "--responses") options.responses = value;
+        else if (arg == "--latency-ms") options.latencyMs = std::stoi(value);
+        else if (arg == "--jitter-ms") options.jitterMs = std::stoi(value);
+        else if (arg == "--error-rate") options.errorRate = std::stod(value);
+        else if (arg == "--error-kind") options.errorKind = value;
+        else if (arg == "--total-hits") options.totalHits = std::stoi(value);
+        else if (arg == "--metadata-fields") options.metadataFields = std::stoi(value);
+        else if (arg == "--file-size") options.fileSize = std::stoll(value);
+        else if (arg == "--rate-limit") options.rateLimit = std::stod(value);
+        else if (arg == "--download-limit") options.downloadLimit = std::stoi(value);
+        else if (arg == "--prepare-ms") options.prepareMs = std::stoi(value);
+        else return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!parseOptions(argc, argv)) {
+        std::cerr << "usage: m2m_standin [--port N] [--responses DIR] [--latency-ms N] [--jitter-ms N]\n"
+                     "                   [--error-rate F] [--error-kind http500|rate-limit|m2m]\n"
+                     "                   [--total-hits N] [--metadata-fields N] [--file-size N]\n"
+                     "                   [--rate-limit N] [--download-limit N] [--prepare-ms N]\n";
+        return 2;
+    }
+
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 128) != 0) {
+        std::cerr << "m2m_standin: cannot listen on port " << options.port << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    std::cout << "m2m_standin listening on http://127.0.0.1:" << options.port << "/api/" << std::endl;
+
+    for (;;) {
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        std::thread(serveConnection, fd).detach();
+    }
+}